@@ -0,0 +1,24 @@
+// tile_animation.frag
+// Plays animated tiles (conveyors) on the GPU, the chunk mesh is never rebuilt.
+// Animated tiles' vertices carry their animation in the vertex colour
+// (ChunkTemplate::animationColor), every other tile is plain white
+
+uniform sampler2D u_texture;    // tileset atlas
+uniform float u_time;           // seconds, or any clock the tiles should follow
+uniform float u_tileStep;       // one tile's width in texture coordinates
+
+void main() {
+    vec4 color = gl_Color;
+    vec2 uv = gl_TexCoord[0].xy;
+
+    // Alpha 254 marks an animated tile: r = frames, g = frame length in
+    // hundredths of a second, b = tiles between frames
+    if (color.a < 0.998) {
+        vec3 animation = floor(color.rgb * 255.0 + 0.5);
+        float frame = mod(floor(u_time * 100.0 / animation.g), animation.r);
+        uv.x += frame * animation.b * u_tileStep;
+        color = vec4(1.0);
+    }
+
+    gl_FragColor = texture2D(u_texture, uv) * color;
+}
@@ -0,0 +1,253 @@
+#include "AssetWatcher.h"
+#include "TilesetTable.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+const AssetWatcher::Folder AssetWatcher::FOLDERS[3] = {
+    { "ASSETS/Tiles", ".tsj" },
+    { "ASSETS/CHUNKS", ".tmj" },
+    { "ASSETS/Shaders", ".frag" },
+};
+
+namespace
+{
+    // Tilesets first: their templates are rebuilt with them, so a chunk saved
+    // in the same batch is decoded against the new table
+    int reloadOrder(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        return extension == ".tsj" ? 0 : (extension == ".tmj" ? 1 : 2);
+    }
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    stop();
+}
+
+void AssetWatcher::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    if (!openWatches())
+        return;
+
+    m_running = true;
+    m_worker = std::thread(&AssetWatcher::workerLoop, this);
+}
+
+void AssetWatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    if (m_worker.joinable())
+        m_worker.join();
+    closeWatches();
+}
+
+std::vector<AssetWatcher::Reload> AssetWatcher::takeReloads()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Reload> ready = std::move(m_ready);
+    m_ready.clear();
+    return ready;
+}
+
+bool AssetWatcher::isWatched(const std::filesystem::path& file) const
+{
+    for (const Folder& folder : FOLDERS)
+        if (file.parent_path() == folder.path && file.extension() == folder.extension)
+            return true;
+    return false;
+}
+
+#ifdef __linux__
+
+bool AssetWatcher::openWatches()
+{
+    m_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notify < 0)
+    {
+        std::cout << "Asset watcher: inotify unavailable, hot reload off" << std::endl;
+        return false;
+    }
+
+    // Editors either rewrite the file or save a temporary and rename it over
+    for (const Folder& folder : FOLDERS)
+    {
+        int watch = inotify_add_watch(m_notify, folder.path, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch < 0)
+            std::cout << "Asset watcher: can't watch " << folder.path << std::endl;
+        else
+            m_watchFolders[watch] = folder.path;
+    }
+
+    std::cout << "Asset watcher: watching " << m_watchFolders.size() << " folders (inotify)" << std::endl;
+    return true;
+}
+
+void AssetWatcher::closeWatches()
+{
+    if (m_notify >= 0)
+        close(m_notify);
+    m_notify = -1;
+    m_watchFolders.clear();
+}
+
+void AssetWatcher::collectChanges(std::vector<std::string>& changed)
+{
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(m_notify, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;  // EAGAIN: nothing more queued
+
+        for (char* at = buffer; at < buffer + length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+            at += sizeof(inotify_event) + event->len;
+
+            auto folder = m_watchFolders.find(event->wd);
+            if (folder == m_watchFolders.end() || event->len == 0)
+                continue;
+
+            std::string path = folder->second + "/" + event->name;
+            if (isWatched(path))
+                changed.push_back(path);
+        }
+    }
+}
+
+#else
+
+// No inotify (the Windows build): compare write times every poll, a couple of
+// dozen stat calls
+bool AssetWatcher::openWatches()
+{
+    std::vector<std::string> ignored;
+    m_writeTimes.clear();
+    collectChanges(ignored);
+
+    std::cout << "Asset watcher: polling " << m_writeTimes.size() << " files every " << POLL_MS << "ms" << std::endl;
+    return true;
+}
+
+void AssetWatcher::closeWatches()
+{
+    m_writeTimes.clear();
+}
+
+void AssetWatcher::collectChanges(std::vector<std::string>& changed)
+{
+    for (const Folder& folder : FOLDERS)
+    {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(folder.path, ec))
+        {
+            std::string path = std::string(folder.path) + "/" + entry.path().filename().string();
+            if (!isWatched(path))
+                continue;
+
+            auto written = std::filesystem::last_write_time(entry.path(), ec);
+            if (ec)
+                continue;
+
+            auto seen = m_writeTimes.find(path);
+            if (seen == m_writeTimes.end() || seen->second != written)
+            {
+                m_writeTimes[path] = written;
+                changed.push_back(path);
+            }
+        }
+    }
+}
+
+#endif
+
+void AssetWatcher::workerLoop()
+{
+    std::set<std::string> pending;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(POLL_MS), [this] { return !m_running; });
+            if (!m_running)
+                break;
+        }
+
+        // Saves arrive as several writes, wait for a quiet poll before reloading
+        std::vector<std::string> changed;
+        collectChanges(changed);
+        if (!changed.empty() || pending.empty())
+        {
+            pending.insert(changed.begin(), changed.end());
+            continue;
+        }
+
+        std::vector<std::string> batch(pending.begin(), pending.end());
+        pending.clear();
+        std::stable_sort(batch.begin(), batch.end(),
+            [](const std::string& a, const std::string& b) { return reloadOrder(a) < reloadOrder(b); });
+
+        for (const std::string& path : batch)
+        {
+            Reload reloaded = reload(path);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.push_back(std::move(reloaded));
+        }
+    }
+}
+
+AssetWatcher::Reload AssetWatcher::reload(const std::string& path)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Reload result;
+    result.path = path;
+
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".tsj")
+    {
+        // Templates are only rebuilt against a table that parsed
+        if (TilesetTable::reload(path))
+            result.templates = ChunkTemplateCache::reloadTileset(path);
+        else
+            std::cout << "Hot reload: " << path << " didn't parse, keeping the old tileset" << std::endl;
+    }
+    else if (extension == ".tmj")
+    {
+        result.templates = ChunkTemplateCache::reload(path);
+    }
+    else
+    {
+        std::ifstream f(path, std::ios::binary);
+        result.shaderSource.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        result.isShader = true;
+    }
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Hot reload: " << path;
+    if (!result.isShader)
+        std::cout << " (" << result.templates.size() << " templates)";
+    std::cout << " prepared in " << ms << "ms" << std::endl;
+    return result;
+}
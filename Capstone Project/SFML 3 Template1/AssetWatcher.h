@@ -0,0 +1,70 @@
+#pragma once
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ChunkTemplate.h"
+
+// Hot reload while editing assets. A worker thread watches ASSETS/CHUNKS
+// (.tmj), ASSETS/Tiles (.tsj) and ASSETS/Shaders (.frag) - inotify on Linux,
+// modification times elsewhere - and re-decodes what changed off the main
+// thread. The main thread only swaps the results in (takeReloads)
+class AssetWatcher
+{
+public:
+    static constexpr int POLL_MS = 250;
+
+    struct Reload
+    {
+        std::string path;
+        // .tmj and .tsj: re-decoded templates, already in ChunkTemplateCache
+        std::vector<std::shared_ptr<const ChunkTemplate>> templates;
+        // .frag: the new source, compiled by whoever owns the GL context
+        std::string shaderSource;
+        bool isShader = false;
+    };
+
+    AssetWatcher() = default;
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    void start();
+    void stop();
+
+    // Main thread, once per frame: everything finished since the last call
+    std::vector<Reload> takeReloads();
+
+private:
+    struct Folder
+    {
+        const char* path;
+        const char* extension;
+    };
+    static const Folder FOLDERS[3];
+
+    void workerLoop();
+    bool openWatches();
+    void closeWatches();
+    void collectChanges(std::vector<std::string>& changed);
+    bool isWatched(const std::filesystem::path& file) const;
+    Reload reload(const std::string& path);
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_running = false;
+    std::vector<Reload> m_ready;
+
+#ifdef __linux__
+    int m_notify = -1;
+    std::unordered_map<int, std::string> m_watchFolders;   // watch descriptor -> folder
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_writeTimes;
+#endif
+};
@@ -1,12 +1,87 @@
 #include "Headers/BpmStream.h"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <vector>
 
+namespace
+{
+    std::uint16_t readU16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+    std::uint32_t readU32(const std::uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24); }
+
+    struct WavInfo
+    {
+        unsigned int sampleRate = 0;
+        unsigned int channelCount = 0;
+        const std::uint8_t* data = nullptr;
+        std::size_t dataBytes = 0;
+    };
+
+    // Walks the RIFF chunks, only accepts what onGetData can play as-is: 16-bit PCM, mono or stereo
+    bool parseWav(const std::uint8_t* file, std::size_t size, WavInfo& info)
+    {
+        if (size < 12 || std::memcmp(file, "RIFF", 4) != 0 || std::memcmp(file + 8, "WAVE", 4) != 0)
+            return false;
+
+        bool haveFormat = false;
+        std::size_t pos = 12;
+        while (pos + 8 <= size)
+        {
+            const std::uint8_t* chunk = file + pos;
+            std::size_t chunkSize = readU32(chunk + 4);
+            std::size_t body = pos + 8;
+
+            if (std::memcmp(chunk, "fmt ", 4) == 0)
+            {
+                if (chunkSize < 16 || body + chunkSize > size)
+                    return false;
+
+                std::uint16_t format = readU16(file + body);
+                info.channelCount = readU16(file + body + 2);
+                info.sampleRate = readU32(file + body + 4);
+                std::uint16_t bitsPerSample = readU16(file + body + 14);
+
+                // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID
+                if (format == 0xFFFE && chunkSize >= 40)
+                    format = readU16(file + body + 24);
+
+                if (format != 1 || bitsPerSample != 16)
+                    return false;
+                if (info.channelCount < 1 || info.channelCount > 2 || info.sampleRate == 0)
+                    return false;
+
+                haveFormat = true;
+            }
+            else if (std::memcmp(chunk, "data", 4) == 0)
+            {
+                if (!haveFormat)
+                    return false;
+
+                // Truncated files still play up to the last whole frame
+                std::size_t frameBytes = info.channelCount * sizeof(std::int16_t);
+                std::size_t available = std::min(chunkSize, size - body);
+                info.data = file + body;
+                info.dataBytes = available - available % frameBytes;
+
+                return (reinterpret_cast<std::uintptr_t>(info.data) % alignof(std::int16_t)) == 0
+                    && info.dataBytes > 0;
+            }
+
+            pos = body + chunkSize + (chunkSize & 1); // chunks are word aligned
+        }
+
+        return false;
+    }
+}
+
 BpmStream::BpmStream()
     : m_bpmDetector(44100.0f)
 {
-    m_floatBuffer.resize(8192);
+    m_floatBuffer.resize(CHUNK_SIZE);
+    m_mixBuffer.resize(CHUNK_SIZE);
     m_bpmDetector.setBPMRange(60.0, 180.0);
 }
 
@@ -14,23 +89,36 @@ bool BpmStream::load(const std::string& filename)
 {
     stop();
 
-    if (!m_buffer.loadFromFile(filename))
+    // Audio thread is stopped, safe to drop the previous source
+    m_file.close();
+    m_buffer = sf::SoundBuffer();
+
+    if (!loadMappedWav(filename))
     {
-        std::cerr << "Failed to load file: " << filename << std::endl;
-        return false;
+        if (!m_buffer.loadFromFile(filename))
+        {
+            std::cerr << "Failed to load file: " << filename << std::endl;
+            m_samples = nullptr;
+            m_totalSamples = 0;
+            return false;
+        }
+
+        m_samples = m_buffer.getSamples();
+        m_totalSamples = m_buffer.getSampleCount();
+        m_sampleRate = m_buffer.getSampleRate();
+        m_channelCount = m_buffer.getChannelCount();
     }
 
-    m_samples = m_buffer.getSamples();
-    m_totalSamples = m_buffer.getSampleCount();
     m_offset = 0;
     m_chunkCounter = 0;
 
-    unsigned int channelCount = m_buffer.getChannelCount();
-    unsigned int sampleRate = m_buffer.getSampleRate();
+    unsigned int channelCount = m_channelCount;
+    unsigned int sampleRate = m_sampleRate;
 
     std::cout << "Audio loaded - Rate: " << sampleRate
         << " Hz, Channels: " << channelCount
-        << ", Samples: " << m_totalSamples << std::endl;
+        << ", Samples: " << m_totalSamples
+        << (m_file.isOpen() ? " (mapped)" : "") << std::endl;
     std::vector<sf::SoundChannel> channelMap;
     if (channelCount == 1)
     {
@@ -47,6 +135,9 @@ bool BpmStream::load(const std::string& filename)
         return false;
     }
     SoundStream::initialize(channelCount, sampleRate, channelMap);
+    m_sfx.prepare(sampleRate, channelCount);
+    m_stretcher.prepare(channelCount);
+    m_stretching = false;
 
     m_bpmDetector.reset();
     m_currentBpm = 0.0;
@@ -57,21 +148,54 @@ bool BpmStream::load(const std::string& filename)
     return true;
 }
 
+// Plays 16-bit PCM WAVs straight out of a memory mapping, no decode or copy
+bool BpmStream::loadMappedWav(const std::string& filename)
+{
+    std::size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string ext = filename.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext != ".wav")
+        return false;
+
+    if (!m_file.open(filename))
+        return false;
+
+    WavInfo info;
+    if (!parseWav(m_file.data(), m_file.size(), info))
+    {
+        std::cout << "WAV is not 16-bit PCM mono/stereo, decoding instead: " << filename << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    m_samples = reinterpret_cast<const int16_t*>(info.data);
+    m_totalSamples = info.dataBytes / sizeof(std::int16_t);
+    m_sampleRate = info.sampleRate;
+    m_channelCount = info.channelCount;
+    return true;
+}
+
 void BpmStream::analyzeBPM()
 {
     std::cout << "Analyzing BPM... (this may take a moment)" << std::endl;
-    unsigned int sampleRate = m_buffer.getSampleRate();
-    unsigned int channelCount = m_buffer.getChannelCount();
-    size_t samplesPerSecond = sampleRate * channelCount;
+    size_t samplesPerSecond = static_cast<size_t>(m_sampleRate) * m_channelCount;
     size_t samplesToAnalyze = std::min(m_totalSamples, samplesPerSecond * 30);
 
-    std::vector<float> floatSamples(samplesToAnalyze);
-    for (size_t i = 0; i < samplesToAnalyze; ++i) // takes samples and normalises
+    // Feed the detector a chunk at a time straight from the source samples
+    for (size_t offset = 0; offset < samplesToAnalyze; offset += CHUNK_SIZE)
     {
-        floatSamples[i] = m_samples[i] / 32768.0f;
+        size_t count = std::min(CHUNK_SIZE, samplesToAnalyze - offset);
+        for (size_t i = 0; i < count; ++i) // takes samples and normalises
+        {
+            m_floatBuffer[i] = m_samples[offset + i] / 32768.0f;
+        }
+        m_bpmDetector.process(m_floatBuffer.data(), static_cast<int>(count));
     }
 
-    m_currentBpm = m_bpmDetector.estimateTempoOfSamples(floatSamples.data(), static_cast<int>(samplesToAnalyze));
+    m_currentBpm = m_bpmDetector.estimateTempo();
     auto candidates = m_bpmDetector.getTempoCandidates();
 
     std::cout << "All BPM candidates:" << std::endl;
@@ -117,7 +241,8 @@ void BpmStream::analyzeBPM()
 
 double BpmStream::getCurrentBPM() const
 {
-    return m_currentBpm;
+    // Stretching plays the same beats faster or slower
+    return m_currentBpm * getTempoRatio();
 }
 
 void BpmStream::reset()
@@ -126,25 +251,122 @@ void BpmStream::reset()
     m_currentBpm = 0.0;
     m_offset = 0;
     m_chunkCounter = 0;
+    m_sfx.reset();
+    m_stretching = false;
+}
+
+bool BpmStream::loadSfx(SfxMixer::Sfx id, const std::string& filename)
+{
+    return m_sfx.loadSound(id, filename);
+}
+
+void BpmStream::playSfx(SfxMixer::Sfx id, SfxMixer::Quantize when, float volume)
+{
+    // Queued events only drain while the stream pulls data
+    if (getStatus() != sf::SoundSource::Status::Playing)
+        return;
+
+    m_sfx.trigger(id, when, volume);
+}
+
+void BpmStream::setTempoRatio(float ratio)
+{
+    m_tempoRatio.store(std::clamp(ratio, 0.5f, 2.f), std::memory_order_relaxed);
+}
+
+float BpmStream::getTempoRatio() const
+{
+    return m_tempoRatio.load(std::memory_order_relaxed);
+}
+
+float BpmStream::getStretchLoad() const
+{
+    return m_stretchLoad.load(std::memory_order_relaxed);
 }
 
 bool BpmStream::onGetData(Chunk& data)
 {
-    constexpr int CHUNK_SIZE = 8192;
+    unsigned int channelCount = m_channelCount;
+    unsigned int sampleRate = m_sampleRate;
+    double ratio = m_tempoRatio.load(std::memory_order_relaxed);
+    bool stretch = std::abs(ratio - 1.0) > 0.001;
 
-    if (m_offset >= m_totalSamples)
-        return false;
+    if (!stretch && m_stretching)
+    {
+        // Back to verbatim playback from wherever the stretcher got to
+        m_offset = static_cast<size_t>(m_stretcher.getPlaybackFrame()) * channelCount;
+        m_stretching = false;
+        m_stretchLoad.store(0.f, std::memory_order_relaxed);
+    }
+
+    // Source frame at the start of this chunk, drives the beat grid
+    double frame = static_cast<double>(m_offset / channelCount);
+    const int16_t* music = nullptr;
+    size_t sampleCount = 0;
+
+    if (stretch)
+    {
+        if (!m_stretching)
+        {
+            m_stretcher.reset(frame);
+            m_stretching = true;
+        }
+        else
+        {
+            frame = m_stretcher.getPlaybackFrame();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t frames = m_stretcher.process(m_samples, m_totalSamples / channelCount, ratio,
+            m_mixBuffer.data(), CHUNK_SIZE / channelCount);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (frames == 0)
+            return false;
 
-    size_t remaining = std::min<size_t>(CHUNK_SIZE, m_totalSamples - m_offset);
+        // Time spent against the playback time the chunk buys us
+        double budget = static_cast<double>(frames) / sampleRate;
+        float load = m_stretchLoad.load(std::memory_order_relaxed);
+        load += (static_cast<float>(elapsed / budget) - load) * 0.1f;
+        m_stretchLoad.store(load, std::memory_order_relaxed);
 
-    data.samples = m_samples + m_offset;
-    data.sampleCount = remaining;
+        m_offset = static_cast<size_t>(m_stretcher.getPlaybackFrame()) * channelCount;
+        music = m_mixBuffer.data();
+        sampleCount = frames * channelCount;
+    }
+    else
+    {
+        if (m_offset >= m_totalSamples)
+            return false;
+
+        sampleCount = std::min<size_t>(CHUNK_SIZE, m_totalSamples - m_offset);
+        music = m_samples + m_offset;
+        m_offset += sampleCount;
+    }
+
+    // Only copy the music when there is something to mix on top of it
+    if (m_sfx.hasWork())
+    {
+        double activeRatio = stretch ? ratio : 1.0;
+        double sourceFramesPerBeat = m_currentBpm > 0.0 ? sampleRate * 60.0 / m_currentBpm : 0.0;
+        double beatPosition = sourceFramesPerBeat > 0.0 ? frame / sourceFramesPerBeat : 0.0;
+
+        if (music != m_mixBuffer.data())
+            std::copy(music, music + sampleCount, m_mixBuffer.begin());
+
+        // Output frames per beat shrink or grow with the stretch
+        m_sfx.mix(m_mixBuffer.data(), sampleCount / channelCount, beatPosition, sourceFramesPerBeat / activeRatio);
+        music = m_mixBuffer.data();
+    }
 
-    m_offset += remaining;
+    data.samples = music;
+    data.sampleCount = sampleCount;
     return true;
 }
 
 void BpmStream::onSeek(sf::Time timeOffset)
 {
-    m_offset = static_cast<size_t>(timeOffset.asSeconds() * m_buffer.getSampleRate() * m_buffer.getChannelCount());
+    m_offset = static_cast<size_t>(timeOffset.asSeconds() * m_sampleRate) * m_channelCount;
+    m_sfx.clearVoices();
+    m_stretching = false;
 }
\ No newline at end of file
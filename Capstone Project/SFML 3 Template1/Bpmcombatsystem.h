@@ -104,6 +104,24 @@ public:
 
     float getBPM() const { return m_bpm; }
 
+    // Pull the beat clock towards an external phase (e.g. Spotify playback).
+    // Small drift is eased out, anything over a quarter beat snaps
+    void alignPhase(float targetPhase)
+    {
+        if (targetPhase < 0.0f)
+            return;
+
+        float error = targetPhase - m_beatPhase;
+        error -= std::round(error); // shortest way round, -0.5..0.5
+
+        if (std::abs(error) > 0.25f)
+            m_beatPhase = targetPhase;
+        else
+            m_beatPhase += error * 0.1f;
+
+        m_beatPhase -= std::floor(m_beatPhase);
+    }
+
 
     void update(float dt)
     {
@@ -1,29 +1,40 @@
 #ifndef CHUNK_H
 #define CHUNK_H
 #include <SFML/Graphics.hpp>
+#include <memory>
 #include <vector>
-#include <unordered_set>
 #include <string>
+#include "ChunkTemplate.h"
+
+// A placed chunk: shared decoded template plus where it sits in the world
 class Chunk {
 private:
-    sf::VertexArray m_vertices;
-    std::vector<int> m_tiles;
-    std::vector<int> m_collisionTiles;
-    const sf::Texture* m_tileset;
-    int m_width, m_height, m_tileSize;
+    std::shared_ptr<const ChunkTemplate> m_template;
+    std::shared_ptr<ChunkTemplate> m_edited;    // m_template once this chunk has changed a tile, never shared with another Chunk
+    const sf::Texture* m_tileset = nullptr;
     sf::Vector2f m_position;
-    std::string m_currentTilesetPath;  // Track which tileset (.tsj) is loaded
 public:
-    static std::unordered_set<int> loadSolidTilesFromTilesetCached(const std::string& path);
     sf::Vector2f m_scale = { 1.f, 1.f };
+
+    Chunk() = default;
+    // A copy gets its own copy of any edited tiles, so each Chunk owns what it writes to
+    Chunk(const Chunk& other);
+    Chunk& operator=(const Chunk& other);
+    Chunk(Chunk&&) = default;
+    Chunk& operator=(Chunk&&) = default;
+
     //  Updated load method with tileset path parameter
     bool load(const std::string& file, const sf::Texture& tileset, int tileSize, const std::string& tilesetPath);
+    // Tileset packed into a larger texture (TilesetAtlas)
+    bool load(const std::string& file, const sf::Texture& texture, int tileSize, const std::string& tilesetPath, const TilesetRegion& region);
+    void setTemplate(std::shared_ptr<const ChunkTemplate> chunkTemplate, const sf::Texture& tileset);
+    const ChunkTemplate* getTemplate() const { return m_template.get(); }
 
-    void draw(sf::RenderTarget& target, sf::Vector2f cameraOffset);
+    // Changes one tile of this chunk only: the shared template is copied the
+    // first time. Returns false if nothing changed. CollisionMap::updateColumn
+    // and ChunkRenderer::setTile then patch just that tile
+    bool setTile(int x, int y, uint16_t id);
 
-    int getTileAt(int x, int y) const;
-    bool isSolidTile(int x, int y) const;
-    bool isSolidTileWorld(float worldX, float worldY) const;
     void drawDebugCollision(sf::RenderTarget& target, sf::Vector2f cameraOffset);
 
     void setScale(float scale);
@@ -34,10 +45,9 @@ public:
 
     float getScaledWidth() const;
 
-    void buildVertexArray();
     void setPosition(sf::Vector2f pos) { m_position = pos; }
     sf::Vector2f getPosition() const { return m_position; }
-    float getWidth() const { return m_width * m_tileSize; }
+    float getWidth() const { return m_template ? static_cast<float>(m_template->width * m_template->tileSize) : 0.f; }
 
     void clearTiles();
 };
@@ -0,0 +1,150 @@
+#include "ChunkBake.h"
+#include "ChunkTemplate.h"
+#include "Headers/DynamicBackground.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    void writeBlock(std::ofstream& out, const void* data, std::size_t size)
+    {
+        if (size > 0)
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+}
+
+std::string ChunkBake::bakedPath(const std::string& chunkFile)
+{
+    return std::filesystem::path(chunkFile).replace_extension(".chunk").string();
+}
+
+bool ChunkBake::isFresh(const std::string& chunkFile, const std::string& tilesetPath)
+{
+    std::error_code ec;
+    auto baked = std::filesystem::last_write_time(bakedPath(chunkFile), ec);
+    if (ec)
+        return false;
+
+    auto chunkTime = std::filesystem::last_write_time(chunkFile, ec);
+    if (ec || chunkTime > baked)
+        return false;
+
+    auto tilesetTime = std::filesystem::last_write_time(tilesetPath, ec);
+    if (!ec && tilesetTime > baked)
+        return false;
+
+    return true;
+}
+
+const ChunkBake::Header* ChunkBake::validate(const std::uint8_t* data, std::size_t size)
+{
+    if (!data || size < sizeof(Header))
+        return nullptr;
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != MAGIC || header->version != VERSION)
+        return nullptr;
+
+    // Same bounds as a Tiled chunk, so the int8 ground rows can't wrap
+    if (!ChunkTemplate::validSize(header->width, header->height))
+        return nullptr;
+    std::size_t tiles = static_cast<std::size_t>(header->width) * header->height;
+
+    auto fits = [size](std::uint32_t offset, std::size_t bytes)
+    {
+        return offset % 4 == 0 && offset <= size && bytes <= size - offset;
+    };
+
+    if (!fits(header->tilesOffset, tiles * sizeof(std::uint16_t))
+        || !fits(header->collisionOffset, ChunkTemplate::solidWords(tiles) * sizeof(std::uint32_t)))
+    {
+        return nullptr;
+    }
+
+    return header;
+}
+
+bool ChunkBake::bake(const std::string& chunkFile, const std::string& tilesetPath, int tileSize)
+{
+    // Always from the JSON, never from a previous bake
+    ChunkTemplate chunk;
+    chunk.file = chunkFile;
+    chunk.tilesetPath = tilesetPath;
+    chunk.tileSize = tileSize;
+    if (!chunk.loadTiled())
+        return false;
+
+    // Ids are padded to a whole word so the collision section stays aligned
+    std::size_t tilesBytes = (chunk.tiles.size() * sizeof(std::uint16_t) + 3) & ~std::size_t(3);
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.width = static_cast<std::uint32_t>(chunk.width);
+    header.height = static_cast<std::uint32_t>(chunk.height);
+    header.tileSize = static_cast<std::uint32_t>(tileSize);
+    header.tilesOffset = sizeof(Header);
+    header.collisionOffset = header.tilesOffset + static_cast<std::uint32_t>(tilesBytes);
+
+    // Write beside the target and rename, so a running game never maps a half-written file
+    std::string target = bakedPath(chunkFile);
+    std::string temp = target + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "Bake: can't write " << temp << std::endl;
+            return false;
+        }
+
+        const std::uint8_t padding[4] = {};
+        writeBlock(out, &header, sizeof(header));
+        writeBlock(out, chunk.tiles.data(), chunk.tiles.size() * sizeof(std::uint16_t));
+        writeBlock(out, padding, tilesBytes - chunk.tiles.size() * sizeof(std::uint16_t));
+        writeBlock(out, chunk.solidBits.data(), chunk.solidBits.size() * sizeof(std::uint32_t));
+
+        if (!out)
+        {
+            std::cerr << "Bake: write failed for " << temp << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, target, ec);
+    if (ec)
+    {
+        std::cerr << "Bake: can't replace " << target << ": " << ec.message() << std::endl;
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    std::cout << "Baked " << chunkFile << " -> " << target << " ("
+        << header.collisionOffset + chunk.solidBits.size() * sizeof(std::uint32_t) << " bytes)" << std::endl;
+    return true;
+}
+
+bool ChunkBake::bakeAll()
+{
+    const int TILE_SIZE = 32;
+    const GameTheme themes[] = { GameTheme::Forest, GameTheme::Medieval, GameTheme::Factory, GameTheme::Hub };
+
+    int baked = 0;
+    int failed = 0;
+    for (GameTheme theme : themes)
+    {
+        std::string tilesetPath = DynamicBackground::GetTilesetPath(theme);
+        for (const std::string& chunkFile : DynamicBackground::GetChunkPaths(theme))
+        {
+            if (bake(chunkFile, tilesetPath, TILE_SIZE))
+                ++baked;
+            else
+                ++failed;
+        }
+    }
+
+    std::cout << "Bake finished: " << baked << " chunks baked, " << failed << " failed" << std::endl;
+    return failed == 0;
+}
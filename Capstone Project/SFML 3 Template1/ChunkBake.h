@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Offline bake of Tiled chunks (.tmj + .tsj) into a flat binary that
+// Chunk::load maps straight into memory instead of parsing JSON:
+//   Header | uint16 tile ids (layers already merged) | collision bits
+// Both sections are ChunkTemplate's in-memory layout, geometry is generated
+// from the ids at load. "SFML 3 Template1.exe --bake" writes one .chunk next to
+// every .tmj, the project runs it after each build. Stale or missing bakes
+// fall back to the .tmj
+class ChunkBake
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x4B484352;  // "RCHK"
+    static constexpr std::uint32_t VERSION = 2;         // 2: uint16 ids, no vertex section
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t width;            // in tiles
+        std::uint32_t height;
+        std::uint32_t tileSize;
+        std::uint32_t tilesOffset;      // uint16 per tile, row-major
+        std::uint32_t collisionOffset;  // one bit per tile, packed into uint32 words
+    };
+
+    static std::string bakedPath(const std::string& chunkFile);
+    // Baked file exists and is at least as new as the chunk and its tileset
+    static bool isFresh(const std::string& chunkFile, const std::string& tilesetPath);
+    // Checks magic, version and that every section lies inside the file
+    static const Header* validate(const std::uint8_t* data, std::size_t size);
+
+    static bool bake(const std::string& chunkFile, const std::string& tilesetPath, int tileSize);
+    // Every chunk of every theme
+    static bool bakeAll();
+};
@@ -0,0 +1,426 @@
+#include "ChunkRenderer.h"
+#include "Chunk.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+void ChunkRenderer::clear()
+{
+    m_vertices.clear();
+    m_columnStart.assign(1, 0);
+    m_slots.clear();
+    m_rows = 0;
+    m_firstColumn = 0;
+    m_chunkCount = 0;
+    m_bufferReady = false;
+    m_hasAnimatedTiles = false;
+    m_rebuildPending = false;
+    m_dirtyBegin = m_dirtyEnd = 0;
+}
+
+int ChunkRenderer::columnOf(const Chunk& chunk) const
+{
+    return static_cast<int>(std::lround(chunk.getPosition().x / m_tileSize));
+}
+
+bool ChunkRenderer::loadAnimationShader(const std::string& path)
+{
+    if (!sf::Shader::isAvailable())
+    {
+        std::cout << "Shaders not supported - animated tiles drawn static" << std::endl;
+        return false;
+    }
+
+    m_animationShaderPath = path;
+    m_animationShaderReady = m_animationShader.loadFromFile(path, sf::Shader::Type::Fragment);
+    if (!m_animationShaderReady)
+    {
+        std::cout << "Failed to load tile animation shader - animated tiles drawn static" << std::endl;
+        return false;
+    }
+
+    m_animationShader.setUniform("u_texture", sf::Shader::CurrentTexture);
+    return true;
+}
+
+bool ChunkRenderer::reloadShader(const std::string& path, const std::string& source)
+{
+    if (path != m_animationShaderPath || !sf::Shader::isAvailable())
+        return false;
+
+    sf::Shader compiled;
+    if (!compiled.loadFromMemory(source, sf::Shader::Type::Fragment))
+    {
+        std::cout << "Tile animation shader didn't compile, keeping the old one" << std::endl;
+        return true;
+    }
+
+    m_animationShader = std::move(compiled);
+    m_animationShader.setUniform("u_texture", sf::Shader::CurrentTexture);
+    if (m_texture)
+        m_animationShader.setUniform("u_tileStep", static_cast<float>(m_tileSize) / m_texture->getSize().x);
+
+    // Animated tiles are only encoded into the mesh while there is a shader
+    if (!m_animationShaderReady)
+    {
+        m_animationShaderReady = true;
+        m_rebuildPending = true;
+    }
+    std::cout << "Tile animation shader reloaded" << std::endl;
+    return true;
+}
+
+void ChunkRenderer::buildMesh(const ChunkTemplate& chunkTemplate, ChunkMesh& out)
+{
+    out.vertices.clear();
+    out.vertices.reserve(chunkTemplate.tileCount * ChunkTemplate::VERTICES_PER_TILE);
+    out.columnStart.clear();
+    out.slots.assign(static_cast<std::size_t>(chunkTemplate.width) * chunkTemplate.height, NO_SLOT);
+
+    for (int x = 0; x < chunkTemplate.width; ++x)
+    {
+        out.columnStart.push_back(static_cast<uint32_t>(out.vertices.size()));
+        if (chunkTemplate.region.columns <= 0)
+            continue;
+
+        for (int y = 0; y < chunkTemplate.height; ++y)
+        {
+            std::size_t start = out.vertices.size();
+            chunkTemplate.appendTile(out.vertices, x, y, sf::Vector2f(0.f, 0.f), true);
+            if (out.vertices.size() != start)
+                out.slots[static_cast<std::size_t>(x) * chunkTemplate.height + y] = static_cast<uint32_t>(start);
+        }
+    }
+    out.columnStart.push_back(static_cast<uint32_t>(out.vertices.size()));
+}
+
+void ChunkRenderer::rebuild(const std::vector<Chunk>& chunks, const sf::Texture& texture)
+{
+    clear();
+    m_chunks = &chunks;
+    m_texture = &texture;
+
+    // Left to right, the chunk vector is in recycle order
+    std::vector<const Chunk*> ordered;
+    for (const Chunk& chunk : chunks)
+    {
+        const ChunkTemplate* tmpl = chunk.getTemplate();
+        if (!tmpl || tmpl->tileSize <= 0)
+            continue;
+
+        if (!ordered.empty() && tmpl->tileSize != m_tileSize)
+        {
+            std::cout << "Chunk renderer: " << tmpl->file << " has a different tile size, skipped" << std::endl;
+            continue;
+        }
+        m_tileSize = tmpl->tileSize;
+        ordered.push_back(&chunk);
+    }
+
+    if (ordered.empty())
+        return;
+
+    std::sort(ordered.begin(), ordered.end(),
+        [](const Chunk* a, const Chunk* b) { return a->getPosition().x < b->getPosition().x; });
+    m_chunkCount = static_cast<unsigned int>(ordered.size());
+
+    std::size_t tiles = 0;
+    std::size_t fullest = 0;
+    for (const Chunk* chunk : ordered)
+    {
+        const ChunkTemplate* tmpl = chunk->getTemplate();
+        m_rows = std::max(m_rows, tmpl->height);
+        tiles += tmpl->tileCount;
+        fullest = std::max(fullest, static_cast<std::size_t>(tmpl->width) * tmpl->height);
+    }
+
+    // Room for twice what is loaded plus a chunk with every tile set, so
+    // recycles keep appending without catching up with the front. Whole tiles
+    // only, no tile's vertices wrap the end
+    m_vertices.assign((2 * tiles + fullest) * ChunkTemplate::VERTICES_PER_TILE, sf::Vertex{});
+    m_firstColumn = columnOf(*ordered.front());
+    for (const Chunk* chunk : ordered)
+    {
+        buildMesh(*chunk->getTemplate(), m_meshScratch);
+        appendChunk(*chunk, m_meshScratch);
+    }
+
+    if (m_animationShaderReady)
+        m_animationShader.setUniform("u_tileStep", static_cast<float>(m_tileSize) / texture.getSize().x);
+
+    // One static upload per rebuild, recycles then upload just their chunk
+    if (sf::VertexBuffer::isAvailable())
+    {
+        m_bufferReady = m_buffer.create(m_vertices.size()) && m_buffer.update(m_vertices.data());
+        if (!m_bufferReady)
+            std::cout << "Chunk renderer: vertex buffer upload failed, drawing from memory" << std::endl;
+    }
+}
+
+void ChunkRenderer::appendChunk(const Chunk& chunk, const ChunkMesh& mesh)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    int first = columnOf(chunk);
+    int lastColumn = m_firstColumn + static_cast<int>(m_columnStart.size()) - 2;
+    std::size_t capacity = m_vertices.size();
+    std::size_t tail = m_columnStart.back();
+
+    // Gaps between chunks are empty columns
+    for (int column = lastColumn + 1; column < first; ++column)
+    {
+        m_columnStart.push_back(tail);
+        m_slots.insert(m_slots.end(), m_rows, NO_SLOT);
+    }
+
+    // Overlaps shouldn't happen, the chunk already there keeps its columns
+    sf::Vector2f offset = chunk.getPosition();
+    std::size_t ring = tail % capacity;
+    for (int x = std::max(lastColumn + 1 - first, 0); x < tmpl->width; ++x)
+    {
+        std::size_t columnRing = ring;
+        for (uint32_t v = mesh.columnStart[x]; v < mesh.columnStart[x + 1]; ++v)
+        {
+            sf::Vertex& out = m_vertices[ring];
+            out = mesh.vertices[v];
+            out.position += offset;
+            if (!m_animationShaderReady)
+                out.color = sf::Color::White;
+            else if (out.color.a != 255)
+                m_hasAnimatedTiles = true;
+
+            if (++ring == capacity)
+                ring = 0;
+        }
+        tail += mesh.columnStart[x + 1] - mesh.columnStart[x];
+        m_columnStart.push_back(tail);
+
+        for (int y = 0; y < m_rows; ++y)
+        {
+            uint32_t local = y < tmpl->height ? mesh.slots[static_cast<std::size_t>(x) * tmpl->height + y] : NO_SLOT;
+            m_slots.push_back(local == NO_SLOT ? NO_SLOT
+                : static_cast<uint32_t>((columnRing + local - mesh.columnStart[x]) % capacity));
+        }
+    }
+}
+
+// At most two uploads, the range may wrap the end of the ring
+void ChunkRenderer::uploadRange(std::size_t begin, std::size_t end)
+{
+    if (!m_bufferReady || begin == end)
+        return;
+
+    std::size_t capacity = m_vertices.size();
+    std::size_t ring = begin % capacity;
+    std::size_t head = std::min(end - begin, capacity - ring);
+    m_bufferReady = m_buffer.update(&m_vertices[ring], head, static_cast<unsigned int>(ring));
+    if (m_bufferReady && end - begin > head)
+        m_bufferReady = m_buffer.update(m_vertices.data(), end - begin - head, 0);
+    if (!m_bufferReady)
+        std::cout << "Chunk renderer: chunk upload failed, drawing from memory" << std::endl;
+}
+
+void ChunkRenderer::removeChunk(const Chunk& chunk)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    int columns = static_cast<int>(m_columnStart.size()) - 1;
+    if (!tmpl || m_rebuildPending || columns <= 0)
+        return;
+
+    int first = columnOf(chunk);
+    int last = first + tmpl->width - 1;
+    int lastColumn = m_firstColumn + columns - 1;
+    if (last < m_firstColumn || first > lastColumn)
+        return;
+    m_chunkCount--;
+
+    // Its vertices stay in the ring until appended chunks write over them
+    if (first <= m_firstColumn)
+    {
+        int dropped = std::min(last, lastColumn) - m_firstColumn + 1;
+        m_columnStart.erase(m_columnStart.begin(), m_columnStart.begin() + dropped);
+        m_slots.erase(m_slots.begin(), m_slots.begin() + static_cast<std::ptrdiff_t>(dropped) * m_rows);
+        m_firstColumn += dropped;
+    }
+    else if (last >= lastColumn)
+    {
+        int dropped = lastColumn - first + 1;
+        m_columnStart.resize(m_columnStart.size() - dropped);
+        m_slots.resize(m_slots.size() - static_cast<std::size_t>(dropped) * m_rows);
+    }
+    else
+    {
+        m_rebuildPending = true;
+    }
+}
+
+void ChunkRenderer::placeChunk(const Chunk& chunk)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || m_rebuildPending)
+        return;
+
+    buildMesh(*tmpl, m_meshScratch);
+    placeChunk(chunk, m_meshScratch);
+}
+
+void ChunkRenderer::placeChunk(const Chunk& chunk, const ChunkMesh& mesh)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || m_rebuildPending)
+        return;
+
+    int first = columnOf(chunk);
+    int columns = static_cast<int>(m_columnStart.size()) - 1;
+    std::size_t live = m_columnStart.back() - m_columnStart.front();
+
+    bool fits = !m_vertices.empty() && tmpl->tileSize == m_tileSize && tmpl->height <= m_rows
+        && (columns == 0 || first > m_firstColumn + columns - 1)
+        && live + mesh.vertices.size() <= m_vertices.size()
+        && mesh.columnStart.size() == static_cast<std::size_t>(tmpl->width) + 1
+        && mesh.slots.size() == static_cast<std::size_t>(tmpl->width) * tmpl->height;
+    if (!fits)
+    {
+        m_rebuildPending = true;
+        return;
+    }
+
+    if (columns == 0)
+        m_firstColumn = first;
+
+    std::size_t begin = m_columnStart.back();
+    appendChunk(chunk, mesh);
+    uploadRange(begin, m_columnStart.back());
+    m_chunkCount++;
+    m_stats.placedChunks++;
+}
+
+void ChunkRenderer::setTile(const Chunk& chunk, int x, int y)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || m_rebuildPending)
+        return;
+
+    int column = columnOf(chunk) + x - m_firstColumn;
+    bool inMesh = column >= 0 && column < static_cast<int>(m_columnStart.size()) - 1 && y >= 0 && y < m_rows;
+    uint32_t slot = inMesh ? m_slots[static_cast<std::size_t>(column) * m_rows + y] : NO_SLOT;
+
+    m_tileScratch.clear();
+    tmpl->appendTile(m_tileScratch, x, y, chunk.getPosition(), m_animationShaderReady);
+
+    if (slot == NO_SLOT)
+    {
+        // Nothing drawn there before or now, else the column needs room
+        if (!m_tileScratch.empty())
+        {
+            m_rebuildPending = true;
+            m_stats.editRebuilds++;
+        }
+        return;
+    }
+
+    // Zero-area triangles draw nothing but hold the slot
+    if (m_tileScratch.empty())
+        m_tileScratch.assign(ChunkTemplate::VERTICES_PER_TILE, sf::Vertex{ m_vertices[slot].position });
+
+    std::copy(m_tileScratch.begin(), m_tileScratch.end(), m_vertices.begin() + slot);
+    m_hasAnimatedTiles |= m_tileScratch.front().color.a != 255;
+
+    std::size_t end = slot + m_tileScratch.size();
+    m_dirtyBegin = m_dirtyBegin == m_dirtyEnd ? slot : std::min<std::size_t>(m_dirtyBegin, slot);
+    m_dirtyEnd = std::max(m_dirtyEnd, end);
+    m_stats.patchedTiles++;
+}
+
+// The frame's edits as one upload: the span from the first patched vertex
+// to the last, or a full rebuild if one of them needed a new slot
+void ChunkRenderer::flushEdits()
+{
+    if (m_rebuildPending)
+    {
+        if (m_chunks && m_texture)
+            rebuild(*m_chunks, *m_texture);
+        return;
+    }
+
+    if (m_dirtyBegin == m_dirtyEnd)
+        return;
+
+    if (m_bufferReady)
+    {
+        m_bufferReady = m_buffer.update(&m_vertices[m_dirtyBegin], m_dirtyEnd - m_dirtyBegin,
+            static_cast<unsigned int>(m_dirtyBegin));
+        if (!m_bufferReady)
+            std::cout << "Chunk renderer: tile patch upload failed, drawing from memory" << std::endl;
+        m_stats.patchUploads++;
+    }
+    m_dirtyBegin = m_dirtyEnd = 0;
+}
+
+void ChunkRenderer::draw(sf::RenderTarget& target, sf::Vector2f cameraOffset)
+{
+    flushEdits();
+
+    if (m_vertices.empty() || !m_texture)
+        return;
+
+    // Same pixel snapping the chunks used: world -> screen is a rounded shift
+    sf::Vector2f shift(-std::round(cameraOffset.x), -std::round(cameraOffset.y));
+
+    // World columns the view covers
+    const sf::View& view = target.getView();
+    float viewLeft = view.getCenter().x - view.getSize().x / 2.f - shift.x;
+    float viewRight = viewLeft + view.getSize().x;
+
+    int columns = static_cast<int>(m_columnStart.size()) - 1;
+    int first = std::max(static_cast<int>(std::floor(viewLeft / m_tileSize)) - m_firstColumn, 0);
+    int last = std::min(static_cast<int>(std::floor(viewRight / m_tileSize)) - m_firstColumn, columns - 1);
+
+    m_stats.frames++;
+    m_stats.loadedVertices += m_columnStart.back() - m_columnStart.front();
+    m_stats.chunkDraws += m_chunkCount;
+    if (first > last)
+        return;
+
+    std::size_t begin = m_columnStart[first];
+    std::size_t count = m_columnStart[last + 1] - begin;
+    if (count == 0)
+        return;
+
+    sf::RenderStates states;
+    states.texture = m_texture;
+    states.transform.translate(shift);
+    if (m_hasAnimatedTiles)
+    {
+        m_animationShader.setUniform("u_time", m_animationTime);
+        states.shader = &m_animationShader;
+    }
+
+    // Contiguous in the ring unless the columns wrap past its end
+    std::size_t ring = begin % m_vertices.size();
+    std::size_t head = std::min(count, m_vertices.size() - ring);
+    std::size_t ranges[2][2] = { { ring, head }, { 0, count - head } };
+
+    sf::Clock submitClock;
+    for (const auto& range : ranges)
+    {
+        if (range[1] == 0)
+            continue;
+
+        if (m_bufferReady && m_useBuffer)
+            target.draw(m_buffer, range[0], range[1], states);
+        else
+            target.draw(&m_vertices[range[0]], range[1], sf::PrimitiveType::Triangles, states);
+        m_stats.submittedVertices += range[1];
+        m_stats.drawCalls++;
+    }
+    if (m_bufferReady && m_useBuffer)
+        m_stats.bufferFrames++;
+    m_stats.submitUs += submitClock.getElapsedTime().asMicroseconds();
+}
+
+ChunkRenderer::Stats ChunkRenderer::takeStats()
+{
+    Stats stats = m_stats;
+    m_stats = Stats();
+    return stats;
+}
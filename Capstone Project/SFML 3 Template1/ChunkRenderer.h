@@ -0,0 +1,121 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Chunk;
+struct ChunkTemplate;
+
+// Every loaded chunk's tiles in one world-space vertex buffer, ordered by
+// tile column. A frame draws just the columns inside the view as a single
+// contiguous range, one draw call whatever the number of chunks (two when
+// the range wraps). The buffer is a ring: a recycled chunk is appended after
+// the last column and the one it replaced drops off the front, so only the
+// new chunk's vertices are copied and uploaded
+class ChunkRenderer
+{
+public:
+    struct Stats
+    {
+        unsigned int frames = 0;
+        unsigned long long submittedVertices = 0;   // what the culled draws sent
+        unsigned long long drawCalls = 0;           // culled draws, two on frames where the view wraps the ring
+        unsigned long long loadedVertices = 0;      // what drawing every chunk whole would have sent
+        unsigned long long chunkDraws = 0;          // draw calls drawing every chunk would have made
+        unsigned int bufferFrames = 0;              // frames drawn from the static vertex buffer
+        double submitUs = 0.0;                      // CPU time in the draw call
+        unsigned int patchedTiles = 0;              // setTile edits written in place
+        unsigned int patchUploads = 0;              // partial buffer uploads, at most one a frame
+        unsigned int editRebuilds = 0;              // edits that needed a slot the mesh didn't have
+        unsigned int placedChunks = 0;              // recycled chunks appended without a rebuild
+    };
+
+    // One chunk's tiles in chunk-local space, column by column
+    struct ChunkMesh
+    {
+        std::vector<sf::Vertex> vertices;
+        std::vector<uint32_t> columnStart;  // first vertex of each column, one past the end last
+        std::vector<uint32_t> slots;        // per tile, column by column: its first vertex or NO_SLOT
+    };
+
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    // Animated tiles are always encoded, placeChunk drops that without the
+    // shader. Touches nothing shared, the streamer's worker calls it
+    static void buildMesh(const ChunkTemplate& chunkTemplate, ChunkMesh& out);
+
+    // After chunks are loaded, reloaded or the theme changes
+    void rebuild(const std::vector<Chunk>& chunks, const sf::Texture& texture);
+    void clear();
+
+    // Recycling: remove before the chunk is moved or given a new template,
+    // place after. Only the chunk at either end can be removed and a chunk can
+    // only be placed after the last column; anything else, or a ring too full
+    // for the new chunk, rebuilds on the next draw
+    void removeChunk(const Chunk& chunk);
+    void placeChunk(const Chunk& chunk, const ChunkMesh& mesh);
+    void placeChunk(const Chunk& chunk);
+
+    // After Chunk::setTile: rewrites the tile's 6 vertices in place. A removed
+    // tile becomes degenerate triangles and keeps its slot for when it comes
+    // back; a tile where the mesh never had one rebuilds on the next draw.
+    // Edits are uploaded together when the frame is drawn
+    void setTile(const Chunk& chunk, int x, int y);
+
+    void draw(sf::RenderTarget& target, sf::Vector2f cameraOffset);
+
+    // Animated tiles are played by this shader. Load it before the first
+    // rebuild; without it they draw their first frame
+    bool loadAnimationShader(const std::string& path);
+    // Hot reload: recompiles if path is the animation shader. A source that
+    // doesn't compile keeps the old shader. False if the path isn't ours
+    bool reloadShader(const std::string& path, const std::string& source);
+    // Advances the animation clock, the only per-frame cost of animated tiles
+    void update(float dt) { m_animationTime += dt; }
+
+    Stats takeStats();
+
+    // Off draws from the vertex array in memory every frame, for comparing
+    // the two submission paths
+    void setVertexBufferEnabled(bool enabled) { m_useBuffer = enabled; }
+    bool vertexBufferEnabled() const { return m_useBuffer; }
+
+private:
+    int columnOf(const Chunk& chunk) const;
+    // Copies the mesh to the ring after the last column, nothing uploaded
+    void appendChunk(const Chunk& chunk, const ChunkMesh& mesh);
+    // Ring positions [begin, end) as counted by m_columnStart, split where they wrap
+    void uploadRange(std::size_t begin, std::size_t end);
+    void flushEdits();
+
+    std::vector<sf::Vertex> m_vertices;        // world space ring, column by column
+    std::vector<std::size_t> m_columnStart;    // first vertex of each column (modulo the ring size), one past the end last
+    std::vector<uint32_t> m_slots;             // per column, m_rows per column: ring index of each tile
+    int m_rows = 0;
+    int m_firstColumn = 0;
+    int m_tileSize = 32;
+    unsigned int m_chunkCount = 0;
+
+    // Edits waiting for the next draw
+    const std::vector<Chunk>* m_chunks = nullptr;
+    bool m_rebuildPending = false;
+    std::size_t m_dirtyBegin = 0;
+    std::size_t m_dirtyEnd = 0;
+    std::vector<sf::Vertex> m_tileScratch;
+    ChunkMesh m_meshScratch;
+
+    sf::VertexBuffer m_buffer{ sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static };
+    bool m_bufferReady = false;
+    bool m_useBuffer = true;
+    const sf::Texture* m_texture = nullptr;
+
+    sf::Shader m_animationShader;
+    std::string m_animationShaderPath;
+    bool m_animationShaderReady = false;
+    bool m_hasAnimatedTiles = false;
+    float m_animationTime = 0.f;
+
+    Stats m_stats;
+};
@@ -0,0 +1,165 @@
+#include "ChunkStreamer.h"
+#include "CollisionMap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+ChunkStreamer::~ChunkStreamer()
+{
+    stop();
+}
+
+void ChunkStreamer::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_worker = std::thread(&ChunkStreamer::workerLoop, this);
+}
+
+void ChunkStreamer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        m_jobs.clear();
+    }
+    m_wake.notify_all();
+
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+void ChunkStreamer::setSource(const std::vector<std::string>& chunkFiles, int tileSize, const std::string& tilesetPath, const TilesetRegion& region)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_files = chunkFiles;
+        m_tileSize = tileSize;
+        m_tilesetPath = tilesetPath;
+        m_region = region;
+
+        m_jobs.clear();
+        for (const std::string& file : m_files)
+            m_jobs.push_back({ file, m_generation, false });
+
+        m_nextReady.reset();
+        m_nextRequested = false;
+        pickNext();
+    }
+    m_wake.notify_one();
+}
+
+void ChunkStreamer::invalidate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_nextReady.reset();
+    m_nextRequested = false;
+}
+
+// Caller holds m_mutex
+void ChunkStreamer::pickNext()
+{
+    m_nextFile = m_files.empty() ? std::string() : m_files[rand() % m_files.size()];
+}
+
+void ChunkStreamer::update(float distanceToRecycle, float velocityX)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_nextRequested || m_nextFile.empty())
+            return;
+
+        // Seconds until the recycle at the current speed
+        bool soon = distanceToRecycle <= LOOKAHEAD_PIXELS
+            || (velocityX > 0.f && distanceToRecycle / velocityX <= LOOKAHEAD_SECONDS);
+        if (!soon)
+            return;
+
+        // Ahead of any warming jobs still queued
+        m_jobs.push_front({ m_nextFile, m_generation, true });
+        m_nextRequested = true;
+    }
+    m_wake.notify_one();
+}
+
+bool ChunkStreamer::takeNext(Prepared& prepared)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_nextReady)
+    {
+        ++m_stats.misses;
+        return false;
+    }
+
+    ++m_stats.hits;
+    prepared = std::move(*m_nextReady);
+    m_nextReady.reset();
+    m_nextRequested = false;
+    pickNext();
+    return true;
+}
+
+ChunkStreamer::Stats ChunkStreamer::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ChunkStreamer::workerLoop()
+{
+    for (;;)
+    {
+        Job job;
+        int tileSize;
+        std::string tilesetPath;
+        TilesetRegion region;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return !m_running || !m_jobs.empty(); });
+            if (!m_running)
+                break;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            tileSize = m_tileSize;
+            tilesetPath = m_tilesetPath;
+            region = m_region;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Prepared> prepared = std::make_unique<Prepared>();
+        prepared->chunk = ChunkTemplateCache::get(job.file, tileSize, tilesetPath, region);
+
+        // Everything the recycle needs, so the main thread only copies
+        if (prepared->chunk && job.isNext)
+        {
+            ChunkRenderer::buildMesh(*prepared->chunk, prepared->mesh);
+            CollisionMap::buildColumns(*prepared->chunk, prepared->solidColumns);
+        }
+        float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!prepared->chunk)
+        {
+            std::cerr << "Chunk streamer: failed to prepare " << job.file << std::endl;
+            if (job.isNext && job.generation == m_generation)
+                m_nextRequested = false; // ask again on the next update
+            continue;
+        }
+
+        ++m_stats.prepared;
+        m_totalPrepareUs += us;
+        m_stats.avgPrepareUs = static_cast<float>(m_totalPrepareUs / m_stats.prepared);
+        m_stats.maxPrepareUs = std::max(m_stats.maxPrepareUs, us);
+
+        // A theme switch since the job was queued makes the result useless
+        if (job.isNext && job.generation == m_generation)
+            m_nextReady = std::move(prepared);
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChunkRenderer.h"
+#include "ChunkTemplate.h"
+
+// Prepares chunks on a worker thread ahead of the player. The next chunk is
+// picked as soon as the player is within LOOKAHEAD_SECONDS of the recycle
+// point (judged from their velocity), then decoded and given its mesh and
+// collision columns off the main thread; the main thread only copies them in
+class ChunkStreamer
+{
+public:
+    static constexpr float LOOKAHEAD_SECONDS = 1.5f;
+    static constexpr float LOOKAHEAD_PIXELS = 320.f;   // also covers a standing or backtracking player
+
+    struct Stats
+    {
+        unsigned int prepared = 0;     // templates the worker finished, the next chunk also meshed
+        unsigned int hits = 0;         // recycles served from a prepared template
+        unsigned int misses = 0;       // recycles that had to load on the main thread
+        float avgPrepareUs = 0.f;
+        float maxPrepareUs = 0.f;
+    };
+
+    // The next chunk, ready for ChunkRenderer::placeChunk and CollisionMap::placeChunk
+    struct Prepared
+    {
+        std::shared_ptr<const ChunkTemplate> chunk;
+        ChunkRenderer::ChunkMesh mesh;
+        std::vector<uint32_t> solidColumns;     // CollisionMap::buildColumns
+    };
+
+    ChunkStreamer() = default;
+    ~ChunkStreamer();
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    void start();
+    void stop();
+
+    // New theme or tileset: drops pending work and warms every file in the background
+    void setSource(const std::vector<std::string>& chunkFiles, int tileSize, const std::string& tilesetPath, const TilesetRegion& region);
+
+    // Templates were reloaded: a prepared chunk or one in flight is stale,
+    // the next one is prepared again from the cache
+    void invalidate();
+
+    // Once per frame. distanceToRecycle is how far the player still has to go
+    // before the leftmost chunk gets recycled, velocityX their speed
+    void update(float distanceToRecycle, float velocityX);
+
+    // Main thread, at the recycle: moves the prepared chunk out, or false if
+    // the worker hasn't finished (counted as a miss). Picks the chunk after it
+    bool takeNext(Prepared& prepared);
+
+    Stats getStats() const;
+
+private:
+    struct Job
+    {
+        std::string file;
+        unsigned int generation = 0;
+        bool isNext = false;    // result goes to takeNext(), otherwise just warms the cache
+    };
+
+    void workerLoop();
+    void pickNext();
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_running = false;
+    std::deque<Job> m_jobs;
+
+    // Source, bumped generation makes in-flight results for an old theme stale
+    unsigned int m_generation = 0;
+    std::vector<std::string> m_files;
+    int m_tileSize = 32;
+    std::string m_tilesetPath;
+    TilesetRegion m_region;
+
+    std::string m_nextFile;
+    bool m_nextRequested = false;
+    std::unique_ptr<Prepared> m_nextReady;
+
+    Stats m_stats;
+    double m_totalPrepareUs = 0.0;
+};
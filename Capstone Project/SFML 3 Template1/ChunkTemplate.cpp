@@ -0,0 +1,396 @@
+#include "ChunkTemplate.h"
+#include "ChunkBake.h"
+#include "MappedFile.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    std::mutex s_templateMutex;
+    std::unordered_map<std::string, std::shared_ptr<const ChunkTemplate>> s_templates;
+
+    // Same file can be placed with tilesets of different widths or atlas positions
+    std::string templateKey(const std::string& chunkFile, int tileSize, const TilesetRegion& region)
+    {
+        return chunkFile + "|" + std::to_string(tileSize) + "|" + std::to_string(region.columns)
+            + "|" + std::to_string(region.uvOffset.x) + "," + std::to_string(region.uvOffset.y);
+    }
+
+    // Re-decodes the cached templates pick() selects, outside the lock, then swaps them in
+    template <typename Pick>
+    std::vector<std::shared_ptr<const ChunkTemplate>> reloadWhere(Pick pick)
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<const ChunkTemplate>>> stale;
+        {
+            std::lock_guard<std::mutex> lock(s_templateMutex);
+            for (const auto& entry : s_templates)
+                if (pick(*entry.second))
+                    stale.push_back(entry);
+        }
+
+        std::vector<std::shared_ptr<const ChunkTemplate>> reloaded;
+        for (const auto& entry : stale) {
+            const ChunkTemplate& old = *entry.second;
+            auto decoded = std::make_shared<ChunkTemplate>();
+            if (!decoded->load(old.file, old.tileSize, old.tilesetPath, old.region)) {
+                std::cout << "Reload of " << old.file << " failed, keeping the old template" << std::endl;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(s_templateMutex);
+            s_templates[entry.first] = decoded;
+            reloaded.push_back(std::move(decoded));
+        }
+        return reloaded;
+    }
+
+    bool isBackground(int id) {
+        return id == 1 || id == 2;
+    }
+}
+
+// Decode a chunk file, baked binary first
+bool ChunkTemplate::load(const std::string& chunkFile, int tilePixels, const std::string& tileset, const TilesetRegion& tilesetRegion) {
+    file = chunkFile;
+    tilesetPath = tileset;
+    tileSize = tilePixels;
+    region = tilesetRegion;
+    tilesetTable = TilesetTable::get(tilesetPath);
+
+    if (!loadBaked() && !loadTiled())
+        return false;
+
+    tileCount = 0;
+    for (uint16_t id : tiles)
+        if (id != 0) ++tileCount;
+
+    buildGroundRows();
+    return true;
+}
+
+// Map the baked .chunk and copy its sections, no parsing
+bool ChunkTemplate::loadBaked() {
+    if (!ChunkBake::isFresh(file, tilesetPath)) {
+        if (std::filesystem::exists(ChunkBake::bakedPath(file)))
+            std::cout << "Baked chunk is older than " << file << ", loading the .tmj" << std::endl;
+        return false;
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(ChunkBake::bakedPath(file)))
+        return false;
+
+    const ChunkBake::Header* header = ChunkBake::validate(mapped.data(), mapped.size());
+    if (!header || header->tileSize != static_cast<std::uint32_t>(tileSize)) {
+        std::cout << "Baked chunk for " << file << " is invalid or out of date, loading the .tmj" << std::endl;
+        return false;
+    }
+
+    width = header->width;
+    height = header->height;
+
+    // Both sections are already in memory layout, copy them as they are
+    std::size_t count = static_cast<std::size_t>(width) * height;
+    tiles.resize(count);
+    std::memcpy(tiles.data(), mapped.data() + header->tilesOffset, count * sizeof(uint16_t));
+
+    solidBits.resize(solidWords(count));
+    std::memcpy(solidBits.data(), mapped.data() + header->collisionOffset, solidBits.size() * sizeof(uint32_t));
+
+    return true;
+}
+
+// Parse the Tiled JSON, merge layers and build the collision map
+bool ChunkTemplate::loadTiled() {
+
+    std::ifstream f(file);
+    if (!f.is_open()) {
+        std::cerr << "Failed to open chunk file: " << file << std::endl;
+        return false;
+    }
+
+    // Runs on the streamer and watcher threads, so a half-saved or hand-broken
+    // file has to fail here: nothing below may throw
+    nlohmann::json data = nlohmann::json::parse(f, nullptr, false);
+    if (data.is_discarded() || !data.is_object() || !data.contains("layers") || !data["layers"].is_array()) {
+        std::cerr << "Failed to parse chunk file: " << file << std::endl;
+        return false;
+    }
+
+    // Dimensions, see validSize
+    auto dimension = [&](const char* key) {
+        auto it = data.find(key);
+        return it != data.end() && it->is_number_integer() ? it->get<int>() : 0;
+    };
+    width = dimension("width");
+    height = dimension("height");
+    if (!validSize(width, height)) {
+        std::cerr << "Chunk file " << file << " has no valid width and height" << std::endl;
+        return false;
+    }
+
+    tiles.assign(static_cast<std::size_t>(width) * height, 0);
+
+    const auto& layers = data["layers"];
+    for (int L = static_cast<int>(layers.size()) - 1; L >= 0; --L) {
+        const auto& layer = layers[L];
+        if (!layer.is_object() || !layer.contains("data") || !layer["data"].is_array())
+            continue;   // object layers carry no tiles
+        const auto& layerData = layer["data"];
+
+        std::size_t count = std::min(layerData.size(), tiles.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!layerData[i].is_number_integer()) {
+                std::cerr << "Chunk file " << file << " has a non-numeric tile" << std::endl;
+                return false;
+            }
+            int64_t id = layerData[i].get<int64_t>();
+
+            if (id == 0) continue;
+
+            // Flipped tiles set Tiled's flag bits, nothing here draws them
+            if (id < 0 || id > UINT16_MAX) {
+                std::cout << "Skipping tile id " << id << " in " << file << std::endl;
+                continue;
+            }
+
+            // if bottom is empty OR bottom is background, overwrite
+            if (tiles[i] == 0 || isBackground(tiles[i])) {
+                tiles[i] = static_cast<uint16_t>(id);
+            }
+        }
+    }
+
+    if (!tilesetTable)
+        tilesetTable = TilesetTable::get(tilesetPath);
+
+    // Build collision map, one table read per tile
+    solidBits.assign(solidWords(tiles.size()), 0u);
+    for (std::size_t i = 0; i < tiles.size(); ++i) {
+        solidBits[i / 32] |= static_cast<uint32_t>(tilesetTable->flags(tiles[i]) & TILE_SOLID) << (i % 32);
+    }
+
+    return true;
+}
+
+// Two triangles for one tile, in chunk-local coordinates plus offset
+void ChunkTemplate::appendTile(std::vector<sf::Vertex>& out, int x, int y, sf::Vector2f offset, bool animate) const {
+    int id = tiles[y * width + x];
+
+    // CRITICAL: Skip empty tiles completely
+    if (id == 0) return;
+
+    // The shader steps the UV through the frames, the mesh never changes
+    sf::Color color = sf::Color::White;
+    if (animate && tilesetTable && tilesetTable->has(static_cast<uint16_t>(id), TILE_ANIMATED)) {
+        if (const TileAnimation* animation = tilesetTable->animation(static_cast<uint16_t>(id)))
+            color = animationColor(*animation);
+    }
+
+    --id;  // Tiled IDs are 1-based
+
+    // Calculate texture coordinates
+    int tu = id % region.columns;
+    int tv = id / region.columns;
+
+    const float epsilon = 0.1f;
+
+    // Calculate positions
+    sf::Vector2f pos(x * tileSize, y * tileSize);
+    pos += offset;
+    sf::Vector2f texPos(tu * tileSize + epsilon, tv * tileSize + epsilon);
+    texPos += region.uvOffset;
+    sf::Vector2f texSize(tileSize - 2 * epsilon, tileSize - 2 * epsilon);
+    float size = static_cast<float>(tileSize);
+
+    // Triangle 1: Top-left corner
+    out.push_back(sf::Vertex{ pos, color, texPos });
+    out.push_back(sf::Vertex{ pos + sf::Vector2f(size, 0), color, texPos + sf::Vector2f(texSize.x, 0) });
+    out.push_back(sf::Vertex{ pos + sf::Vector2f(0, size), color, texPos + sf::Vector2f(0, texSize.y) });
+
+    // Triangle 2: Bottom-right corner
+    out.push_back(sf::Vertex{ pos + sf::Vector2f(size, 0), color, texPos + sf::Vector2f(texSize.x, 0) });
+    out.push_back(sf::Vertex{ pos + sf::Vector2f(size, size), color, texPos + texSize });
+    out.push_back(sf::Vertex{ pos + sf::Vector2f(0, size), color, texPos + sf::Vector2f(0, texSize.y) });
+}
+
+sf::Color ChunkTemplate::animationColor(const TileAnimation& animation) {
+    return sf::Color(animation.frames, animation.frameCs, animation.stride, 254);
+}
+
+void ChunkTemplate::appendVertices(std::vector<sf::Vertex>& out, sf::Vector2f offset, bool animate) const {
+    if (region.columns <= 0)
+        return;
+
+    out.reserve(out.size() + static_cast<std::size_t>(tileCount) * VERTICES_PER_TILE);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            appendTile(out, x, y, offset, animate);
+}
+
+void ChunkTemplate::appendColumnVertices(std::vector<sf::Vertex>& out, int x, sf::Vector2f offset, bool animate) const {
+    if (region.columns <= 0 || x < 0 || x >= width)
+        return;
+
+    for (int y = 0; y < height; ++y)
+        appendTile(out, x, y, offset, animate);
+}
+
+// Surface lookup for ground snapping, ledge checks and spawns, so none of
+// them has to step down through the column at runtime
+void ChunkTemplate::buildGroundRows() {
+    groundRows.assign(static_cast<std::size_t>(width) * height, -1);
+
+    for (int x = 0; x < width; ++x)
+        buildGroundColumn(x);
+}
+
+void ChunkTemplate::buildGroundColumn(int x) {
+    int8_t* column = &groundRows[static_cast<std::size_t>(x) * height];
+    auto solid = [&](int y) { return isSolid(x, y); };
+
+    // Solid tiles stand on the top of their run
+    int runTop = -1;
+    for (int y = 0; y < height; ++y) {
+        if (solid(y)) {
+            if (y == 0 || !solid(y - 1))
+                runTop = y;
+            column[y] = static_cast<int8_t>(runTop);
+        }
+    }
+
+    // Empty tiles fall to the next run below
+    int8_t below = -1;
+    for (int y = height - 1; y >= 0; --y) {
+        if (solid(y))
+            below = column[y];
+        else
+            column[y] = below;
+    }
+}
+
+bool ChunkTemplate::sameSource(const ChunkTemplate& other) const {
+    return file == other.file && tileSize == other.tileSize && region.columns == other.region.columns
+        && region.uvOffset == other.region.uvOffset;
+}
+
+std::shared_ptr<ChunkTemplate> ChunkTemplate::editableCopy() const {
+    auto copy = std::make_shared<ChunkTemplate>();
+    copy->file = file;
+    copy->tilesetPath = tilesetPath;
+    copy->width = width;
+    copy->height = height;
+    copy->tileSize = tileSize;
+    copy->region = region;
+    copy->tilesetTable = tilesetTable;
+    copy->tiles = tiles;
+    copy->solidBits = solidBits;
+    copy->groundRows = groundRows;
+    copy->tileCount = tileCount;
+    return copy;
+}
+
+bool ChunkTemplate::setTile(int x, int y, uint16_t id) {
+    if (x < 0 || x >= width || y < 0 || y >= height)
+        return false;
+
+    std::size_t i = static_cast<std::size_t>(y) * width + x;
+    uint16_t old = tiles[i];
+    if (old == id)
+        return false;
+
+    tiles[i] = id;
+    tileCount += (id != 0) - (old != 0);
+
+    uint32_t bit = 1u << (i % 32);
+    bool solid = tilesetTable && tilesetTable->has(id, TILE_SOLID);
+    solidBits[i / 32] = solid ? (solidBits[i / 32] | bit) : (solidBits[i / 32] & ~bit);
+    if (groundRows.size() == static_cast<std::size_t>(width) * height)
+        buildGroundColumn(x);
+    return true;
+}
+
+std::size_t ChunkTemplate::memoryBytes() const {
+    return sizeof(*this) + file.capacity() + tilesetPath.capacity()
+        + tiles.capacity() * sizeof(uint16_t)
+        + solidBits.capacity() * sizeof(uint32_t)
+        + groundRows.capacity() * sizeof(int8_t);
+}
+
+std::size_t ChunkTemplate::expandedMemoryBytes() const {
+    std::size_t count = static_cast<std::size_t>(width) * height;
+    return sizeof(*this) + file.capacity() + tilesetPath.capacity()
+        + count * sizeof(int) * 2
+        + static_cast<std::size_t>(tileCount) * VERTICES_PER_TILE * sizeof(sf::Vertex)
+        + groundRows.capacity() * sizeof(int8_t);
+}
+
+std::shared_ptr<const ChunkTemplate> ChunkTemplateCache::get(const std::string& chunkFile, int tileSize,
+    const std::string& tilesetPath, const TilesetRegion& region)
+{
+    std::string key = templateKey(chunkFile, tileSize, region);
+    {
+        std::lock_guard<std::mutex> lock(s_templateMutex);
+        auto it = s_templates.find(key);
+        if (it != s_templates.end())
+            return it->second;
+    }
+
+    // Decode without holding the lock so other threads' hits aren't held up
+    auto decoded = std::make_shared<ChunkTemplate>();
+    if (!decoded->load(chunkFile, tileSize, tilesetPath, region))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(s_templateMutex);
+    auto inserted = s_templates.emplace(key, std::move(decoded));
+    if (inserted.second) {
+        const ChunkTemplate& added = *inserted.first->second;
+        std::cout << "Cached chunk template " << chunkFile << " (" << s_templates.size() << " cached, "
+            << added.memoryBytes() << " bytes, " << added.expandedMemoryBytes() << " with prebuilt vertices)" << std::endl;
+    }
+    return inserted.first->second;
+}
+
+void ChunkTemplateCache::preload(const std::vector<std::string>& chunkFiles, int tileSize,
+    const std::string& tilesetPath, const TilesetRegion& region)
+{
+    for (const std::string& chunkFile : chunkFiles)
+        get(chunkFile, tileSize, tilesetPath, region);
+}
+
+std::vector<std::shared_ptr<const ChunkTemplate>> ChunkTemplateCache::reload(const std::string& chunkFile)
+{
+    return reloadWhere([&](const ChunkTemplate& cached) { return cached.file == chunkFile; });
+}
+
+std::vector<std::shared_ptr<const ChunkTemplate>> ChunkTemplateCache::reloadTileset(const std::string& tilesetPath)
+{
+    return reloadWhere([&](const ChunkTemplate& cached) { return cached.tilesetPath == tilesetPath; });
+}
+
+void ChunkTemplateCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_templateMutex);
+    s_templates.clear();
+}
+
+std::size_t ChunkTemplateCache::size()
+{
+    std::lock_guard<std::mutex> lock(s_templateMutex);
+    return s_templates.size();
+}
+
+std::size_t ChunkTemplateCache::memoryBytes()
+{
+    std::lock_guard<std::mutex> lock(s_templateMutex);
+    std::size_t total = 0;
+    for (const auto& entry : s_templates)
+        total += entry.second->memoryBytes();
+    return total;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TilesetTable.h"
+
+// Where a tileset's tiles sit in the texture chunks are drawn with
+struct TilesetRegion
+{
+    int columns = 0;            // tiles per row
+    sf::Vector2f uvOffset;      // top-left corner of the tileset in the texture
+};
+
+// Decoded chunk file: merged tile ids and a collision bitset, built once per
+// file and shared read-only by every Chunk placed from it, so placing a chunk
+// never touches the disk. Geometry isn't kept: SFML has no index buffers, so
+// the 6 vertices per tile are generated from the ids when something needs them
+struct ChunkTemplate
+{
+    static constexpr int VERTICES_PER_TILE = 6;
+    static constexpr int MAX_HEIGHT = INT8_MAX;    // ground rows are stored as int8
+    static constexpr int MAX_WIDTH = 1024;         // far past any real chunk, keeps width * height small
+
+    // Both decode paths (Tiled and baked) hold chunks to this
+    static bool validSize(long long w, long long h) { return w > 0 && h > 0 && w <= MAX_WIDTH && h <= MAX_HEIGHT; }
+
+    std::string file;
+    std::string tilesetPath;
+    int width = 0;
+    int height = 0;
+    int tileSize = 0;
+    TilesetRegion region;
+    std::shared_ptr<const TilesetTable> tilesetTable;  // per-id flags: solid, one-way, hazard...
+    std::vector<uint16_t> tiles;        // merged ids, row-major, 0 = empty
+    std::vector<uint32_t> solidBits;    // one bit per tile, row-major
+    // Per tile, column-major: the row whose top a body at that tile stands on.
+    // Inside solid ground it is the top of that ground, in the air the first
+    // ground below, -1 when the column is open to the bottom
+    std::vector<int8_t> groundRows;
+    int tileCount = 0;                  // non-empty tiles, 6 vertices each when drawn
+
+    // Baked binary first, Tiled JSON when there is no up to date bake
+    bool load(const std::string& chunkFile, int tilePixels, const std::string& tileset, const TilesetRegion& tilesetRegion);
+    bool loadBaked();
+    bool loadTiled();
+    void buildGroundRows();
+    void buildGroundColumn(int x);
+
+    // Decoded from the same file for the same tile size and atlas position
+    bool sameSource(const ChunkTemplate& other) const;
+
+    // Private copy of the tile data for a chunk that edits its tiles
+    std::shared_ptr<ChunkTemplate> editableCopy() const;
+    // Changes one tile and keeps the collision bit, ground rows and tile count
+    // in step. Only for a template no other chunk shares. False if unchanged
+    bool setTile(int x, int y, uint16_t id);
+
+    bool isSolid(int x, int y) const
+    {
+        std::size_t i = static_cast<std::size_t>(y) * width + x;
+        return (solidBits[i / 32] >> (i % 32)) & 1u;
+    }
+    static std::size_t solidWords(std::size_t tiles) { return (tiles + 31) / 32; }
+
+    // Triangles for every non-empty tile, row by row, or for one column top to
+    // bottom, shifted by offset. With animate, animated tiles carry their
+    // animation in the vertex colour for the tile shader (animationColor) and
+    // must be drawn with it; without, they show their first frame
+    void appendVertices(std::vector<sf::Vertex>& out, sf::Vector2f offset, bool animate = false) const;
+    void appendColumnVertices(std::vector<sf::Vertex>& out, int x, sf::Vector2f offset, bool animate = false) const;
+
+    // Frame count, frame length and stride packed into r, g and b, alpha 254
+    // marks the tile as animated. ASSETS/Shaders/tile_animation.frag unpacks it
+    static sf::Color animationColor(const TileAnimation& animation);
+
+    // CPU bytes held, and what the old int ids + int collision + prebuilt
+    // vertex array layout needed for the same chunk
+    std::size_t memoryBytes() const;
+    std::size_t expandedMemoryBytes() const;
+
+    // One tile's 6 vertices, nothing for an empty tile
+    void appendTile(std::vector<sf::Vertex>& out, int x, int y, sf::Vector2f offset, bool animate = false) const;
+};
+
+// Templates by file. Safe to use from any thread; loads happen outside the lock
+class ChunkTemplateCache
+{
+public:
+    // The vertices' UVs depend on where the tileset sits in the texture
+    static std::shared_ptr<const ChunkTemplate> get(const std::string& chunkFile, int tileSize,
+        const std::string& tilesetPath, const TilesetRegion& region);
+    // Decode every file up front so the first placement doesn't hit the disk either
+    static void preload(const std::vector<std::string>& chunkFiles, int tileSize,
+        const std::string& tilesetPath, const TilesetRegion& region);
+    // Decode every cached template of this chunk file, or built with this
+    // tileset, again and replace them. Chunks already placed keep the old
+    // ones until given the returned templates (ChunkTemplate::sameSource).
+    // A file that fails to decode keeps its old template
+    static std::vector<std::shared_ptr<const ChunkTemplate>> reload(const std::string& chunkFile);
+    static std::vector<std::shared_ptr<const ChunkTemplate>> reloadTileset(const std::string& tilesetPath);
+    static void clear();
+    static std::size_t size();
+    static std::size_t memoryBytes();
+};
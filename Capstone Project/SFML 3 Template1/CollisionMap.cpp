@@ -0,0 +1,296 @@
+#include "CollisionMap.h"
+#include "Chunk.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    constexpr int EMPTY_SLOT = INT_MIN;
+    // Pushes the cross-axis span along its own motion at the moment of a crossing,
+    // so a box meeting a tile exactly corner-on still hits it
+    constexpr float CORNER_NUDGE = 0.001f;
+
+    float nudge(float velocity)
+    {
+        return velocity > 0.f ? CORNER_NUDGE : (velocity < 0.f ? -CORNER_NUDGE : 0.f);
+    }
+}
+
+void CollisionMap::clear()
+{
+    m_bits.fill(0u);
+    m_columnOf.fill(EMPTY_SLOT);
+    for (auto& rows : m_groundRows)
+        rows.fill(-1);
+}
+
+void CollisionMap::rebuild(const std::vector<Chunk>& chunks)
+{
+    clear();
+    for (const Chunk& chunk : chunks)
+        placeChunk(chunk);
+}
+
+bool CollisionMap::fits(const ChunkTemplate& chunkTemplate)
+{
+    if (chunkTemplate.tileSize != TILE_SIZE)
+    {
+        std::cout << "CollisionMap: " << chunkTemplate.file << " uses " << chunkTemplate.tileSize
+            << "px tiles, expected " << TILE_SIZE << std::endl;
+        return false;
+    }
+
+    if (chunkTemplate.width > CAPACITY)
+    {
+        std::cout << "CollisionMap: " << chunkTemplate.file << " is wider than the map" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CollisionMap::placeChunk(const Chunk& chunk)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || !fits(*tmpl))
+        return;
+
+    for (int x = 0; x < tmpl->width; ++x)
+        placeColumn(chunk, x);
+}
+
+void CollisionMap::placeChunk(const Chunk& chunk, const std::vector<uint32_t>& solidColumns)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || solidColumns.size() != static_cast<std::size_t>(tmpl->width) || firstRowOf(chunk) != 0)
+    {
+        placeChunk(chunk);
+        return;
+    }
+
+    if (!fits(*tmpl))
+        return;
+
+    for (int x = 0; x < tmpl->width; ++x)
+        storeColumn(chunk, x, solidColumns[x]);
+}
+
+void CollisionMap::buildColumns(const ChunkTemplate& chunkTemplate, std::vector<uint32_t>& out)
+{
+    out.resize(static_cast<std::size_t>(std::max(chunkTemplate.width, 0)));
+    for (int x = 0; x < chunkTemplate.width; ++x)
+        out[x] = solidBits(chunkTemplate, x, 0);
+}
+
+void CollisionMap::updateColumn(const Chunk& chunk, int x)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl || tmpl->tileSize != TILE_SIZE || x < 0 || x >= tmpl->width || tmpl->width > CAPACITY)
+        return;
+
+    placeColumn(chunk, x);
+}
+
+// Chunks sit on the tile grid, round away float drift from summed widths
+int CollisionMap::firstRowOf(const Chunk& chunk)
+{
+    return static_cast<int>(std::lround((chunk.getPosition().y - ORIGIN_Y) / TILE_SIZE));
+}
+
+uint32_t CollisionMap::solidBits(const ChunkTemplate& chunkTemplate, int x, int firstRow)
+{
+    uint32_t bits = 0u;
+    for (int y = 0; y < chunkTemplate.height; ++y)
+    {
+        int row = firstRow + y;
+        if (row < 0 || row >= ROWS)
+            continue;
+        if (chunkTemplate.isSolid(x, y))
+            bits |= 1u << row;
+    }
+    return bits;
+}
+
+void CollisionMap::placeColumn(const Chunk& chunk, int x)
+{
+    storeColumn(chunk, x, solidBits(*chunk.getTemplate(), x, firstRowOf(chunk)));
+}
+
+void CollisionMap::storeColumn(const Chunk& chunk, int x, uint32_t bits)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    int firstColumn = static_cast<int>(std::lround((chunk.getPosition().x - ORIGIN_X) / TILE_SIZE));
+    int firstRow = firstRowOf(chunk);
+
+    int column = firstColumn + x;
+    int slot = column & MASK;
+    m_bits[slot] = bits;
+    m_columnOf[slot] = column;
+
+    // Above the chunk a body lands on whatever its top row lands on
+    bool hasGround = tmpl->groundRows.size() == static_cast<std::size_t>(tmpl->width) * tmpl->height;
+    const int8_t* ground = hasGround ? &tmpl->groundRows[static_cast<std::size_t>(x) * tmpl->height] : nullptr;
+    for (int row = 0; row < ROWS; ++row)
+    {
+        int y = std::max(row - firstRow, 0);
+        int8_t groundRow = -1;
+        if (ground && y < tmpl->height && ground[y] >= 0 && firstRow + ground[y] < ROWS)
+            groundRow = static_cast<int8_t>(firstRow + ground[y]);
+        m_groundRows[slot][row] = groundRow;
+    }
+}
+
+void CollisionMap::removeChunk(const Chunk& chunk)
+{
+    const ChunkTemplate* tmpl = chunk.getTemplate();
+    if (!tmpl)
+        return;
+
+    int firstColumn = static_cast<int>(std::lround((chunk.getPosition().x - ORIGIN_X) / TILE_SIZE));
+    for (int x = 0; x < tmpl->width && x < CAPACITY; ++x)
+    {
+        int column = firstColumn + x;
+        int slot = column & MASK;
+        if (m_columnOf[slot] == column)
+        {
+            m_bits[slot] = 0u;
+            m_columnOf[slot] = EMPTY_SLOT;
+            m_groundRows[slot].fill(-1);
+        }
+    }
+}
+
+uint32_t CollisionMap::rowMask(int firstRow, int lastRow)
+{
+    if (firstRow < 0)
+        firstRow = 0;
+    if (lastRow >= ROWS)
+        lastRow = ROWS - 1;
+    if (firstRow > lastRow)
+        return 0u;
+
+    uint32_t upTo = lastRow == ROWS - 1 ? ~0u : (1u << (lastRow + 1)) - 1u;
+    return upTo & ~((1u << firstRow) - 1u);
+}
+
+bool CollisionMap::isSolid(float worldX, float worldY) const
+{
+    int row = rowAt(worldY);
+    if (row < 0 || row >= ROWS)
+        return false;
+    return (columnBits(columnAt(worldX)) >> row) & 1u;
+}
+
+bool CollisionMap::isSolidSpan(float worldX, float topY, float bottomY) const
+{
+    return (columnBits(columnAt(worldX)) & rowMask(rowAt(topY), rowAt(bottomY))) != 0u;
+}
+
+bool CollisionMap::isSolidBox(const sf::FloatRect& box) const
+{
+    uint32_t rows = rowMask(rowAt(box.position.y), rowAt(box.position.y + box.size.y));
+    if (rows == 0u)
+        return false;
+
+    int lastColumn = columnAt(box.position.x + box.size.x);
+    for (int column = columnAt(box.position.x); column <= lastColumn; ++column)
+    {
+        if (columnBits(column) & rows)
+            return true;
+    }
+    return false;
+}
+
+bool CollisionMap::surfaceBelow(float worldX, float worldY, float& surfaceY) const
+{
+    int column = columnAt(worldX);
+    int slot = column & MASK;
+    int row = std::max(rowAt(worldY), 0);
+    if (m_columnOf[slot] != column || row >= ROWS)
+        return false;
+
+    int8_t groundRow = m_groundRows[slot][row];
+    if (groundRow < 0)
+        return false;
+
+    surfaceY = ORIGIN_Y + groundRow * static_cast<float>(TILE_SIZE);
+    return true;
+}
+
+void CollisionMap::tileRange(float lo, float size, float origin, int& first, int& last)
+{
+    first = static_cast<int>(std::floor((lo - origin) / TILE_SIZE));
+    last = std::max(first, static_cast<int>(std::ceil((lo + size - origin) / TILE_SIZE)) - 1);
+}
+
+CollisionMap::SweepHit CollisionMap::sweep(const sf::FloatRect& box, sf::Vector2f delta) const
+{
+    SweepHit result;
+
+    // Columns entered by the leading vertical edge
+    if (delta.x != 0.f)
+    {
+        int step = delta.x > 0.f ? 1 : -1;
+        float lead = delta.x > 0.f ? box.position.x + box.size.x : box.position.x;
+        float edge = (lead - ORIGIN_X) / TILE_SIZE;
+        int column = step > 0 ? static_cast<int>(std::ceil(edge)) : static_cast<int>(std::floor(edge)) - 1;
+
+        while (true)
+        {
+            float boundary = ORIGIN_X + static_cast<float>((step > 0 ? column : column + 1) * TILE_SIZE);
+            float t = (boundary - lead) / delta.x;
+            if (t > 1.f)
+                break;
+
+            int firstRow, lastRow;
+            tileRange(box.position.y + delta.y * t + nudge(delta.y), box.size.y, ORIGIN_Y, firstRow, lastRow);
+            if (columnBits(column) & rowMask(firstRow, lastRow))
+            {
+                result.hit = true;
+                result.time = std::max(t, 0.f);
+                result.normal = { static_cast<float>(-step), 0.f };
+                break;
+            }
+            column += step;
+        }
+    }
+
+    // Rows entered by the leading horizontal edge, only up to an earlier wall hit
+    if (delta.y != 0.f)
+    {
+        int step = delta.y > 0.f ? 1 : -1;
+        float lead = delta.y > 0.f ? box.position.y + box.size.y : box.position.y;
+        float edge = (lead - ORIGIN_Y) / TILE_SIZE;
+        int row = step > 0 ? static_cast<int>(std::ceil(edge)) : static_cast<int>(std::floor(edge)) - 1;
+
+        while (true)
+        {
+            float boundary = ORIGIN_Y + static_cast<float>((step > 0 ? row : row + 1) * TILE_SIZE);
+            float t = (boundary - lead) / delta.y;
+            if (t > result.time || (step > 0 && row >= ROWS) || (step < 0 && row < 0))
+                break;
+
+            if (row >= 0 && row < ROWS)
+            {
+                int firstColumn, lastColumn;
+                tileRange(box.position.x + delta.x * t + nudge(delta.x), box.size.x, ORIGIN_X, firstColumn, lastColumn);
+
+                bool solid = false;
+                for (int column = firstColumn; column <= lastColumn && !solid; ++column)
+                    solid = (columnBits(column) >> row) & 1u;
+
+                if (solid)
+                {
+                    result.hit = true;
+                    result.time = std::max(t, 0.f);
+                    result.normal = { 0.f, static_cast<float>(-step) };
+                    break;
+                }
+            }
+            row += step;
+        }
+    }
+
+    return result;
+}
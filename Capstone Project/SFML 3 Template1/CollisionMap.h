@@ -0,0 +1,92 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class Chunk;
+struct ChunkTemplate;
+
+// World-space solid tiles, one 32-bit mask per tile column (bit = row below
+// ORIGIN_Y). Columns live in a ring indexed by world column, so a placed chunk
+// just overwrites the slots it covers and every query is a couple of array
+// reads with no loop over chunks. Rebuilt when chunks load, patched on recycle
+class CollisionMap
+{
+public:
+    struct SweepHit
+    {
+        bool hit = false;
+        float time = 1.f;                   // fraction of the move made before touching
+        sf::Vector2f normal{ 0.f, 0.f };    // face that was hit, pointing back at the box
+    };
+
+    static constexpr float ORIGIN_X = 0.f;
+    static constexpr float ORIGIN_Y = 190.f;      // every chunk is placed at this y
+    static constexpr int TILE_SIZE = 32;
+    static constexpr int ROWS = 32;               // one bit per row, chunks are 20 tall
+    static constexpr int CAPACITY = 256;          // columns kept, 8192px - the live world is ~60
+    static constexpr int MASK = CAPACITY - 1;
+
+    CollisionMap() { clear(); }
+
+    void clear();
+    // Drop everything and add these chunks
+    void rebuild(const std::vector<Chunk>& chunks);
+    void placeChunk(const Chunk& chunk);
+    // Same with the solid bits from buildColumns, worked out again if the
+    // chunk isn't at ORIGIN_Y or they don't match its template
+    void placeChunk(const Chunk& chunk, const std::vector<uint32_t>& solidColumns);
+    // Solid bits of each tile column for a chunk placed at ORIGIN_Y. Touches
+    // nothing shared: the streamer's worker calls it
+    static void buildColumns(const ChunkTemplate& chunkTemplate, std::vector<uint32_t>& out);
+    // Call before a chunk is moved or given a new template
+    void removeChunk(const Chunk& chunk);
+    // After Chunk::setTile, re-reads the one tile column (bits and ground rows)
+    void updateColumn(const Chunk& chunk, int x);
+
+    static int columnAt(float worldX) { return static_cast<int>(std::floor((worldX - ORIGIN_X) / TILE_SIZE)); }
+    static int rowAt(float worldY) { return static_cast<int>(std::floor((worldY - ORIGIN_Y) / TILE_SIZE)); }
+    // World y of the top edge of the tile containing worldY
+    static float tileTop(float worldY) { return ORIGIN_Y + rowAt(worldY) * static_cast<float>(TILE_SIZE); }
+
+    // Solid bits of a world column, 0 if nothing is loaded there
+    uint32_t columnBits(int column) const
+    {
+        int slot = column & MASK;
+        return m_columnOf[slot] == column ? m_bits[slot] : 0u;
+    }
+
+    bool isSolid(float worldX, float worldY) const;
+    // Any solid tile in one column between two heights (inclusive)
+    bool isSolidSpan(float worldX, float topY, float bottomY) const;
+    // Any solid tile touched by the box, edges included like the old corner checks
+    bool isSolidBox(const sf::FloatRect& box) const;
+
+    // Top of the ground a body at (worldX, worldY) stands on: the top of the
+    // solid run it is in, else the first walkable surface below. One lookup
+    // into the rows each chunk template precomputed. False if the column is open
+    bool surfaceBelow(float worldX, float worldY, float& surfaceY) const;
+
+    // Moves the box by delta and returns the first contact. Walks the tile
+    // columns and rows its leading edges cross (DDA), so nothing is skipped
+    // however far it moves in one frame. Tiles it already overlaps are ignored,
+    // a box resting against a tile hits it at time 0. Zero width or height boxes
+    // (a feet point) sweep the one tile column/row they sit in
+    SweepHit sweep(const sf::FloatRect& box, sf::Vector2f delta) const;
+
+private:
+    void placeColumn(const Chunk& chunk, int x);
+    void storeColumn(const Chunk& chunk, int x, uint32_t bits);
+    static bool fits(const ChunkTemplate& chunkTemplate);
+    static int firstRowOf(const Chunk& chunk);
+    static uint32_t solidBits(const ChunkTemplate& chunkTemplate, int x, int firstRow);
+    static uint32_t rowMask(int firstRow, int lastRow);
+    // Tiles covered by [lo, lo + size), at least the one lo is in
+    static void tileRange(float lo, float size, float origin, int& first, int& last);
+
+    std::array<uint32_t, CAPACITY> m_bits{};
+    std::array<int, CAPACITY> m_columnOf{};   // world column owning each slot
+    std::array<std::array<int8_t, ROWS>, CAPACITY> m_groundRows{};  // ChunkTemplate::groundRows in map rows
+};
@@ -1,7 +1,7 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <vector>
-#include "Chunk.h"
+#include "CollisionMap.h"
 
 // Unified collision and ground detection for ALL enemy types
 class EnemyCollision
@@ -11,36 +11,31 @@ public:
     static constexpr float ENEMY_HITBOX_WIDTH = 40.f;
     static constexpr float ENEMY_HITBOX_HEIGHT = 60.f;
 
-    // Check horizontal collision and prevent wall-walking
+    // Check horizontal collision and prevent wall-walking. Sweeps the hitbox
+    // from fromX (where the enemy started the frame) to where its update and
+    // knockback moved it, so a fast shove can't carry it through a thin wall
     static bool CheckHorizontalCollision(
         sf::Vector2f& pos,
         sf::Vector2f& velocity,
-        const std::vector<Chunk>& chunks,
-        float dt)
+        const CollisionMap& collision,
+        float fromX)
     {
-        // Apply horizontal movement
-        float oldX = pos.x;
-        pos.x += velocity.x * dt;
+        float moveX = pos.x - fromX;
+        if (moveX == 0.f)
+            return false;
 
-        // Check collision at new position 
         sf::FloatRect hitbox(
-            sf::Vector2f(pos.x - ENEMY_HITBOX_WIDTH / 2.f, pos.y - ENEMY_HITBOX_HEIGHT / 2.f),
+            sf::Vector2f(fromX - ENEMY_HITBOX_WIDTH / 2.f, pos.y - ENEMY_HITBOX_HEIGHT / 2.f),
             sf::Vector2f(ENEMY_HITBOX_WIDTH, ENEMY_HITBOX_HEIGHT)
         );
 
-        // Check all four corners of hitbox
-        for (auto& chunk : chunks)
+        CollisionMap::SweepHit hit = collision.sweep(hitbox, { moveX, 0.f });
+        if (hit.hit)
         {
-            if (chunk.isSolidTileWorld(hitbox.position.x, hitbox.position.y) ||
-                chunk.isSolidTileWorld(hitbox.position.x + hitbox.size.x, hitbox.position.y) ||
-                chunk.isSolidTileWorld(hitbox.position.x, hitbox.position.y + hitbox.size.y) ||
-                chunk.isSolidTileWorld(hitbox.position.x + hitbox.size.x, hitbox.position.y + hitbox.size.y))
-            {
-                // Hit wall  revert position and stop
-                pos.x = oldX;
-                velocity.x = 0.f;
-                return true; // Collision detected
-            }
+            // Hit wall  stop against it
+            pos.x = fromX + moveX * hit.time;
+            velocity.x = 0.f;
+            return true; // Collision detected
         }
 
         return false; // No collision
@@ -50,7 +45,7 @@ public:
     static bool ApplyGravityAndGround(
         sf::Vector2f& pos,
         sf::Vector2f& velocity,
-        const std::vector<Chunk>& chunks,
+        const CollisionMap& collision,
         float dt,
         float gravity = 980.f)
     {
@@ -58,40 +53,35 @@ public:
 
         // Check if currently on ground
         bool onGround = false;
-        for (auto& chunk : chunks)
+        float groundY = 0.f;
+        if (collision.surfaceBelow(pos.x, feetY, groundY) && groundY <= feetY + 2.f) // Check slightly below
         {
-            if (chunk.isSolidTileWorld(pos.x, feetY + 2.f)) // Check slightly below
-            {
-                // On ground - snap to it
-                float chunkRelativeY = feetY - chunk.getPosition().y;
-                int tileY = static_cast<int>(chunkRelativeY / 32.f);
-                pos.y = chunk.getPosition().y + (tileY * 32.f) - 30.f;
-                velocity.y = 0.f;
-                onGround = true;
-                break;
-            }
+            // On ground - snap to it
+            pos.y = groundY - 30.f;
+            velocity.y = 0.f;
+            onGround = true;
         }
 
         // If not on ground, apply gravity
         if (!onGround)
         {
             velocity.y += gravity * dt;
-            pos.y += velocity.y * dt;
+            float fallY = velocity.y * dt;
 
-            // Check if we hit ground while falling
-            feetY = pos.y + 30.f;
-            for (auto& chunk : chunks)
+            // Sweep the feet down so a fast fall lands on the first tile it reaches
+            CollisionMap::SweepHit hit = fallY > 0.f
+                ? collision.sweep(sf::FloatRect({ pos.x, feetY }, { 0.f, 0.f }), { 0.f, fallY })
+                : CollisionMap::SweepHit{};
+            if (hit.hit)
+            {
+                // Hit ground
+                pos.y = pos.y + fallY * hit.time;
+                velocity.y = 0.f;
+                onGround = true;
+            }
+            else
             {
-                if (chunk.isSolidTileWorld(pos.x, feetY))
-                {
-                    // Hit ground
-                    float chunkRelativeY = feetY - chunk.getPosition().y;
-                    int tileY = static_cast<int>(chunkRelativeY / 32.f);
-                    pos.y = chunk.getPosition().y + (tileY * 32.f) - 30.f;
-                    velocity.y = 0.f;
-                    onGround = true;
-                    break;
-                }
+                pos.y += fallY;
             }
         }
 
@@ -101,41 +91,26 @@ public:
     // Check if position is valid spawn location (on solid ground)
     static bool IsValidSpawnPosition(
         sf::Vector2f pos,
-        const std::vector<Chunk>& chunks)
+        const CollisionMap& collision)
     {
         float feetY = pos.y + 30.f;
 
         // Check if there's ground beneath spawn point
-        for (auto& chunk : chunks)
-        {
-            if (chunk.isSolidTileWorld(pos.x, feetY))
-            {
-                return true;
-            }
-        }
-
-        return false;
+        return collision.isSolid(pos.x, feetY);
     }
 
     // Find nearest valid ground Y position for given X coordinate
     static float FindGroundY(
         float x,
         float startY,
-        const std::vector<Chunk>& chunks,
+        const CollisionMap& collision,
         float searchRange = 200.f)
     {
-        // Search downward for ground
-        for (float y = startY; y < startY + searchRange; y += 4.f)
+        // Ground below, precomputed per column
+        float groundY = 0.f;
+        if (collision.surfaceBelow(x, startY, groundY) && groundY < startY + searchRange)
         {
-            for (auto& chunk : chunks)
-            {
-                if (chunk.isSolidTileWorld(x, y))
-                {
-                    // Found ground tile
-                    int tileY = static_cast<int>((y - chunk.getPosition().y) / 32.f);
-                    return chunk.getPosition().y + (tileY * 32.f) - 30.f;
-                }
-            }
+            return groundY - 30.f;
         }
 
         // No ground found, return original Y
@@ -147,28 +122,16 @@ public:
     static bool IsLedgeAhead(
         sf::Vector2f pos,
         bool facingRight,
-        const std::vector<Chunk>& chunks,
+        const CollisionMap& collision,
         float lookAheadDistance = 50.f)
     {
         // Check position slightly ahead in the direction enemy is facing
         float checkX = facingRight ? pos.x + lookAheadDistance : pos.x - lookAheadDistance;
         float checkY = pos.y + 40.f; // Check below feet level
 
-        // Check if there's solid ground ahead
-        bool foundGround = false;
-        for (auto& chunk : chunks)
-        {
-            // Check multiple points downward to be thorough
-            for (float yOffset = 0.f; yOffset <= 64.f; yOffset += 16.f)
-            {
-                if (chunk.isSolidTileWorld(checkX, checkY + yOffset))
-                {
-                    foundGround = true;
-                    break;
-                }
-            }
-            if (foundGround) break;
-        }
+        // Check if there's solid ground ahead, within 64px below
+        float groundY = 0.f;
+        bool foundGround = collision.surfaceBelow(checkX, checkY, groundY) && groundY <= checkY + 64.f;
 
         // Return TRUE if NO ground found
         return !foundGround;
@@ -179,9 +142,9 @@ public:
         sf::Vector2f pos,
         bool facingRight,
         sf::Vector2f& velocity,
-        const std::vector<Chunk>& chunks)
+        const CollisionMap& collision)
     {
-        if (IsLedgeAhead(pos, facingRight, chunks, 45.f))
+        if (IsLedgeAhead(pos, facingRight, collision, 45.f))
         {
             // Stop moving at ledge
             velocity.x = 0.f;
@@ -1,7 +1,7 @@
 #include "EnemySpawnManager.h"
 #include <iostream>
 #include <cmath>
-#include "Chunk.h"
+#include "CollisionMap.h"
 #include "EnemyCollision.h"
 
 EnemySpawnManager::EnemySpawnManager()
@@ -40,7 +40,7 @@ void EnemySpawnManager::SetDifficultyMultiplier(float multiplier)
 void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
     std::vector<Enemy1>& enemies, std::vector<Enemy2>& archers,
     std::vector<Enemy3>& executioners,
-    float rightmostChunkX, const std::vector<Chunk>& chunks)
+    float rightmostChunkX, const CollisionMap& collision)
 {
     // Update cooldowns
     spawnCooldownTimer -= dt;
@@ -99,7 +99,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
         {
             if (executioner.health <= 0)
             {
-                float spawnY = GetSpawnY(execSpawnX, chunks, playerPos.y);
+                float spawnY = GetSpawnY(execSpawnX, collision, playerPos.y);
 
                 executioner.SetupEnemy3();
                 executioner.Reset();
@@ -121,7 +121,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
             auto& newExecutioner = executioners.back();
             newExecutioner.SetupEnemy3();
 
-            float spawnY = GetSpawnY(execSpawnX, chunks, playerPos.y);
+            float spawnY = GetSpawnY(execSpawnX, collision, playerPos.y);
             newExecutioner.pos = { execSpawnX, spawnY };
             newExecutioner.sprite->setPosition(newExecutioner.pos);
 
@@ -150,7 +150,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
             {
                 if (enemy.health <= 0)
                 {
-                    float spawnY = GetSpawnY(spawnX, chunks);
+                    float spawnY = GetSpawnY(spawnX, collision);
 
                     enemy.SetupEnemy1();
                     enemy.Reset();
@@ -172,7 +172,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
                 auto& newEnemy = enemies.back();
                 newEnemy.SetupEnemy1();
 
-                float spawnY = GetSpawnY(spawnX, chunks);
+                float spawnY = GetSpawnY(spawnX, collision);
                 newEnemy.pos = { spawnX, spawnY };
                 newEnemy.sprite->setPosition(newEnemy.pos);
 
@@ -215,7 +215,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
             {
                 if (archer.health <= 0)
                 {
-                    float spawnY = GetSpawnY(archerSpawnX, chunks);
+                    float spawnY = GetSpawnY(archerSpawnX, collision);
 
                     archer.SetupEnemy2();
                     archer.Reset();
@@ -238,7 +238,7 @@ void EnemySpawnManager::Update(float dt, sf::Vector2f playerPos,
                 newArcher.SetupEnemy2();
                 newArcher.Reset();
 
-                float spawnY = GetSpawnY(archerSpawnX, chunks);
+                float spawnY = GetSpawnY(archerSpawnX, collision);
                 newArcher.pos = { archerSpawnX, spawnY };
                 newArcher.sprite->setPosition(newArcher.pos);
 
@@ -373,9 +373,9 @@ float EnemySpawnManager::GetRandomSpawnX(sf::Vector2f playerPos, float rightmost
     return potentialSpawnX;
 }
 
-float EnemySpawnManager::GetSpawnY(float spawnX, const std::vector<Chunk>& chunks, float searchStartY)
+float EnemySpawnManager::GetSpawnY(float spawnX, const CollisionMap& collision, float searchStartY)
 {
-    float groundY = EnemyCollision::FindGroundY(spawnX, searchStartY, chunks, 300.f);
+    float groundY = EnemyCollision::FindGroundY(spawnX, searchStartY, collision, 300.f);
     return groundY;
 }
 
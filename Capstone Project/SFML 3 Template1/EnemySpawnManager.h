@@ -8,7 +8,7 @@
 #include "Enemy3.h"
 
 // Forward declaration
-class Chunk;
+class CollisionMap;
 
 // Spawn configuration for different enemy types
 struct EnemySpawnConfig {
@@ -44,7 +44,7 @@ public:
         std::vector<Enemy2>& archers,
         std::vector<Enemy3>& executioners,  
         float rightmostChunkX,
-        const std::vector<Chunk>& chunks);
+        const CollisionMap& collision);
 
     // Manual spawn
     void ForceSpawn(sf::Vector2f position, std::vector<Enemy1>& enemies);
@@ -88,7 +88,7 @@ private:
 
     // Helper methods
     float GetRandomSpawnX(sf::Vector2f playerPos, float rightmostChunkX);
-    float GetSpawnY(float spawnX, const std::vector<Chunk>& chunks, float searchStartY = 500.f);
+    float GetSpawnY(float spawnX, const CollisionMap& collision, float searchStartY = 500.f);
     bool CanSpawnAt(float worldX);
     void CleanupOldSpawnRecords(float currentTime);
     bool IsValidSpawnPosition(float worldX, float playerX, float rightmostChunkX);
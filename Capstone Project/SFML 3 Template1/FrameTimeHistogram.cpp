@@ -0,0 +1,44 @@
+#include "FrameTimeHistogram.h"
+#include <algorithm>
+#include <cstdio>
+
+void FrameTimeHistogram::record(float ms)
+{
+    int bucket = std::clamp(static_cast<int>(ms / BUCKET_MS), 0, BUCKETS);
+    ++m_buckets[bucket];
+    ++m_count;
+    m_totalMs += ms;
+    m_maxMs = std::max(m_maxMs, ms);
+}
+
+void FrameTimeHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_totalMs = 0.0;
+    m_maxMs = 0.f;
+}
+
+float FrameTimeHistogram::percentile(float p) const
+{
+    if (m_count == 0)
+        return 0.f;
+
+    unsigned int target = static_cast<unsigned int>(p * (m_count - 1)) + 1;
+    unsigned int seen = 0;
+    for (int i = 0; i <= BUCKETS; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return i == BUCKETS ? m_maxMs : (i + 1) * BUCKET_MS;
+    }
+    return m_maxMs;
+}
+
+std::string FrameTimeHistogram::summary(const std::string& label) const
+{
+    char text[192];
+    std::snprintf(text, sizeof(text), "%s: %u frames, mean %.2fms, p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms",
+        label.c_str(), m_count, mean(), percentile(0.5f), percentile(0.95f), percentile(0.99f), m_maxMs);
+    return text;
+}
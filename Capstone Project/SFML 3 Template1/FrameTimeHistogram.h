@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <string>
+
+// Fixed-bucket frame time histogram, 0.25ms buckets up to 50ms plus an
+// overflow bucket. Recording is a single increment, no allocation
+class FrameTimeHistogram
+{
+public:
+    static constexpr float BUCKET_MS = 0.25f;
+    static constexpr int BUCKETS = 200;
+
+    void record(float ms);
+    void reset();
+
+    unsigned int count() const { return m_count; }
+    float mean() const { return m_count ? static_cast<float>(m_totalMs / m_count) : 0.f; }
+    float max() const { return m_maxMs; }
+    // Upper edge of the bucket holding the p-th fraction of frames (p in 0..1)
+    float percentile(float p) const;
+
+    // "label: n frames, mean, p50, p95, p99, max"
+    std::string summary(const std::string& label) const;
+
+private:
+    std::array<unsigned int, BUCKETS + 1> m_buckets{};
+    unsigned int m_count = 0;
+    double m_totalMs = 0.0;
+    float m_maxMs = 0.f;
+};
@@ -31,6 +31,8 @@ Game::Game() :
 		throw std::runtime_error("Failed to load enemy textures");
 	}
 
+	m_chunkStreamer.start();
+	m_assetWatcher.start();
 }
 /// <summary>
 /// default destructor we didn't dynamically allocate anything
@@ -38,6 +40,10 @@ Game::Game() :
 /// </summary>
 Game::~Game()
 {
+	m_chunkStreamer.stop();
+	m_assetWatcher.stop();
+	m_spotifyClient.StopPolling();
+	m_spotifyBridge.Stop();
 }
 
 
@@ -54,10 +60,12 @@ void Game::run()
 	sf::Time timeSinceLastUpdate = sf::Time::Zero;
 	const float fps{ 60.0f };
 	sf::Time timePerFrame = sf::seconds(1.0f / fps);
+	sf::Clock frameClock; // work per loop, not including the wait for the next update
 	while (m_window.isOpen())
 	{
 		processEvents();
 		timeSinceLastUpdate += clock.restart();
+		frameClock.restart();
 		while (timeSinceLastUpdate > timePerFrame)
 		{
 			timeSinceLastUpdate -= timePerFrame;
@@ -65,6 +73,7 @@ void Game::run()
 			update(timePerFrame);
 		}
 		render();
+		recordFrameTime(frameClock.getElapsedTime().asMicroseconds() / 1000.f);
 	}
 }
 /// <summary>
@@ -130,13 +139,8 @@ void Game::processEvents()
 						{
 							m_useSpotify = true;
 
-							// Start Spotify API for track info
-							std::cout << "Starting Spotify server..." << std::endl;
-							#ifdef _WIN32
-							system("start cmd /k \"..\\..\\Spotify test\\start_spotify_server.bat\"");
-							#endif
-							std::this_thread::sleep_for(std::chrono::seconds(3));
-							m_spotifyClient.StartPolling();
+							// Start Spotify API for track info, polling begins once the bridge reports ready
+							startSpotifyBridge();
 
 						}
 						initializeGame(); //  moved out of constructor
@@ -166,6 +170,37 @@ void Game::processEvents()
 	}
 }
 
+void Game::startSpotifyBridge()
+{
+	auto onReady = [this](bool ok, const std::string& message)
+	{
+		// If the port is taken another bridge (e.g. the Node one) is already serving it
+		std::cout << "Spotify bridge " << (ok ? "ready: " : "not started: ") << message << std::endl;
+		m_spotifyBridgeReady = true;
+	};
+
+	// Offline stand-in when a replay timeline is given, otherwise the live bridge
+	std::string timeline = SpotifyBridge::ReplayTimelineFromEnvironment();
+	if (!timeline.empty())
+	{
+		if (m_spotifyBridge.Start(SpotifyBridge::Mode::Replay, onReady, timeline))
+			return;
+	}
+	else if (SpotifyBridge::LiveSupported())
+	{
+		if (m_spotifyBridge.Start(SpotifyBridge::Mode::Live, onReady))
+			return;
+	}
+
+	// No credentials for the in-process bridge, fall back to the Node server.
+	// The client keeps retrying until it comes up, so no need to wait for it here
+	std::cout << "Starting Node Spotify server..." << std::endl;
+#ifdef _WIN32
+	system("start cmd /k \"..\\..\\Spotify test\\start_spotify_server.bat\"");
+#endif
+	m_spotifyBridgeReady = true;
+}
+
 void Game::initializeGame()
 {
 	m_bpmText.setFont(m_jerseyFont);
@@ -201,13 +236,12 @@ void Game::initializeGame()
 	m_isInHub = true;
 	m_currentGameTheme = GameTheme::Hub;
 
-	// Load HUB tileset
-	std::string tilesetPath = DynamicBackground::GetTilesetTexturePath(m_currentGameTheme);
-	if (!m_tilesetTexture.loadFromFile(tilesetPath))
+	// Load every theme's tileset once, theme switches never touch the disk or the GPU
+	if (!m_tilesetAtlas.load(32))
 	{
-		std::cout << "Failed to load hub tileset: " << tilesetPath << std::endl;
+		std::cout << "Failed to load tileset atlas" << std::endl;
 	}
-	m_tilesetTexture.setSmooth(false);
+	m_chunkRenderer.loadAnimationShader("ASSETS/Shaders/tile_animation.frag");
 
 	// Clear enemies 
 	m_enemies.clear();
@@ -221,7 +255,9 @@ void Game::initializeGame()
 
 
 	// USE HUB CLASS TO LOAD
-	m_hub.Load(m_tilesetTexture, m_chunks, m_Player, m_chunkWidth, m_jerseyFont, m_windowSize);
+	m_hub.Load(m_tilesetAtlas, m_chunks, m_Player, m_chunkWidth, m_jerseyFont, m_windowSize);
+	m_collisionMap.rebuild(m_chunks);
+	m_chunkRenderer.rebuild(m_chunks, m_tilesetAtlas.getTexture());
 
 
 	m_screenEffect.initialize(m_windowSize);
@@ -285,6 +321,19 @@ void Game::processKeys(const std::optional<sf::Event> t_event)
 		m_showDebugCollision = !m_showDebugCollision;
 		std::cout << "Debug collision: " << (m_showDebugCollision ? "ON" : "OFF") << std::endl;
 	}
+	if (sf::Keyboard::Key::F4 == newKeypress->code)
+	{
+		// Report the current path before switching so the two can be compared
+		reportFrameTimes();
+		m_chunkRenderer.setVertexBufferEnabled(!m_chunkRenderer.vertexBufferEnabled());
+		std::cout << "Chunk vertex buffer: " << (m_chunkRenderer.vertexBufferEnabled() ? "ON" : "OFF") << std::endl;
+	}
+	if (sf::Keyboard::Key::F5 == newKeypress->code && m_showDebugCollision)
+	{
+		// Debug view only (F3): knock out the tile under the player's feet, for testing tile edits
+		if (setWorldTile({ m_Player.pos.x, m_Player.pos.y + 51.f }, 0))
+			std::cout << "Removed tile under the player" << std::endl;
+	}
 }
 
 /// <summary>
@@ -311,12 +360,23 @@ void Game::update(sf::Time t_deltaTime)
 	checkKeyboardState();
 	float dt = t_deltaTime.asSeconds();
 
+	if (m_useSpotify && m_spotifyBridgeReady.exchange(false))
+		m_spotifyClient.StartPolling();
+
 	if (m_bpmCombat)
 	{
 		m_bpmCombat->setBPM(m_currentBPM);
 		m_bpmCombat->update(dt);
+
+		// Keep the beat clock on Spotify's playback position between polls
+		if (m_useSpotify)
+			m_bpmCombat->alignPhase(m_spotifyClient.GetBeatPhase(m_spotifyBeatOffsetMs));
 	}
 
+	// Animated tiles only need the clock moved, the shader picks the frame
+	m_chunkRenderer.update(dt);
+	applyAssetReloads();
+
 	// ===== PLAYER INPUT =====
 	if (!m_showSkillTree && !(m_isInHub && m_hub.IsShopOpen()))
 	{
@@ -374,55 +434,26 @@ void Game::update(sf::Time t_deltaTime)
 	}
 
 	// ===== PLAYER COLLISION  =====
-	sf::Vector2f oldPos = m_Player.pos;
-	m_Player.pos.x += m_Player.velocity.x * dt;
-
-	sf::FloatRect playerBox(
-		{ m_Player.pos.x - PLAYER_HITBOX_WIDTH / 2.f, m_Player.pos.y - PLAYER_HITBOX_HEIGHT / 10.f },
-		{ PLAYER_HITBOX_WIDTH, PLAYER_HITBOX_HEIGHT }
-	);
-
-	bool hitWall = false;
-	for (auto& chunk : m_chunks)
-	{
-		if (chunk.isSolidTileWorld(playerBox.position.x, playerBox.position.y) ||
-			chunk.isSolidTileWorld(playerBox.position.x + playerBox.size.x, playerBox.position.y) ||
-			chunk.isSolidTileWorld(playerBox.position.x, playerBox.position.y + playerBox.size.y) ||
-			chunk.isSolidTileWorld(playerBox.position.x + playerBox.size.x, playerBox.position.y + playerBox.size.y))
-		{
-			hitWall = true;
-			break;
-		}
-	}
-
-	if (hitWall)
-	{
-		m_Player.pos.x = oldPos.x;
-		m_Player.velocity.x = 0;
-	}
+	movePlayerSwept({ m_Player.velocity.x * dt, 0.f });
 
 	m_Player.isOnGround = false;
 	float playerFeetY = m_Player.pos.y + 50.0f;
 
-	for (auto& chunk : m_chunks)
+	float groundY = 0.f;
+	if (m_Player.velocity.y >= 0 && m_collisionMap.surfaceBelow(m_Player.pos.x, playerFeetY, groundY) && groundY <= playerFeetY)
 	{
-		if (chunk.isSolidTileWorld(m_Player.pos.x, playerFeetY))
-		{
-			if (m_Player.velocity.y >= 0)
-			{
-				m_Player.isOnGround = true;
-				m_Player.velocity.y = 0;
-
-				float chunkRelativeY = playerFeetY - chunk.getPosition().y;
-				float tileSize = 32.f; // or chunk.getTileSize()
-				int tileY = static_cast<int>(chunkRelativeY / tileSize);
-				m_Player.pos.y = chunk.getPosition().y + tileY * tileSize - 50.f;
-				break;
-			}
-		}
+		m_Player.isOnGround = true;
+		m_Player.velocity.y = 0;
+		m_Player.pos.y = groundY - 50.f;
 	}
 
+	// The player integrates its own velocity, knockback and attack lunge,
+	// take that move back and replay it against the tiles
+	sf::Vector2f beforeUpdate = m_Player.pos;
 	m_Player.Update(dt);
+	sf::Vector2f playerMove = m_Player.pos - beforeUpdate;
+	m_Player.pos = beforeUpdate;
+	movePlayerSwept(playerMove);
 
 	if (m_DELETEexitGame)
 	{
@@ -435,8 +466,7 @@ void Game::update(sf::Time t_deltaTime)
 		float rawBPM = 0.f;
 		if (m_useSpotify)
 		{
-			auto trackInfo = m_spotifyClient.GetCurrentTrack();
-			rawBPM = trackInfo.bpm;
+			rawBPM = m_spotifyClient.GetBpm();
 		}
 		else
 		{
@@ -471,14 +501,8 @@ void Game::update(sf::Time t_deltaTime)
 			m_dynamicBackground.setCurrentTheme(m_currentGameTheme);
 			m_dynamicBackground.loadtheme(DynamicBackground::GetBackgroundPath(m_currentGameTheme));
 
-			// Load expedition tileset
-			std::string tilesetPath = DynamicBackground::GetTilesetTexturePath(m_currentGameTheme);
-			if (m_tilesetTexture.loadFromFile(tilesetPath))
-			{
-				m_tilesetTexture.setSmooth(false);
-			}
-
 			// Load expedition chunks
+			streamChunkTheme();
 			m_chunks.clear();
 			m_chunks.resize(VISIBLE_CHUNKS);
 			loadChunkAt(0, 0);
@@ -487,6 +511,8 @@ void Game::update(sf::Time t_deltaTime)
 			{
 				loadChunkAt(i, i * m_chunkWidth);
 			}
+			m_collisionMap.rebuild(m_chunks);
+			m_chunkRenderer.rebuild(m_chunks, m_tilesetAtlas.getTexture());
 
 			// Position player
 			m_Player.pos.x = 500.f;
@@ -520,8 +546,7 @@ void Game::update(sf::Time t_deltaTime)
 		float rawBPM = 0.f;
 		if (m_useSpotify)
 		{
-			auto trackInfo = m_spotifyClient.GetCurrentTrack();
-			rawBPM = trackInfo.bpm;
+			rawBPM = m_spotifyClient.GetBpm();
 		}
 		else
 		{
@@ -557,18 +582,16 @@ void Game::update(sf::Time t_deltaTime)
 				m_dynamicBackground.setCurrentTheme(newTheme);
 				m_dynamicBackground.transitionTo(DynamicBackground::GetBackgroundPath(newTheme));
 
-				std::string newTilesetPath = DynamicBackground::GetTilesetTexturePath(newTheme);
-				if (m_tilesetTexture.loadFromFile(newTilesetPath))
+				// Tileset is already in the atlas, only the chunk templates change
+				streamChunkTheme();
+				for (int i = 0; i < m_chunks.size(); ++i)
 				{
-					m_tilesetTexture.setSmooth(false);
-					std::cout << "Loaded new tileset: " << newTilesetPath << std::endl;
-
-					for (int i = 0; i < m_chunks.size(); ++i)
-					{
-						float chunkX = m_chunks[i].getPosition().x;
-						loadChunkAt(i, chunkX);
-					}
+					float chunkX = m_chunks[i].getPosition().x;
+					loadChunkAt(i, chunkX);
 				}
+				m_collisionMap.rebuild(m_chunks);
+				m_chunkRenderer.rebuild(m_chunks, m_tilesetAtlas.getTexture());
+				m_chunkTransitionThisFrame = true;
 			}
 		}
 
@@ -579,6 +602,8 @@ void Game::update(sf::Time t_deltaTime)
 
 		if (m_Player.health <= 0)
 		{
+			reportFrameTimes();
+
 			// Switch state
 			m_isInHub = true;
 			m_currentGameTheme = GameTheme::Hub;
@@ -598,15 +623,11 @@ void Game::update(sf::Time t_deltaTime)
 			m_arrows.clear();
 			m_executioners.clear();
 
-			// Reload hub tileset
-			std::string tilesetPath =
-				DynamicBackground::GetTilesetTexturePath(GameTheme::Hub);
-			m_tilesetTexture.loadFromFile(tilesetPath);
-			m_tilesetTexture.setSmooth(false);
-
 			// Reload hub chunks
 			m_chunks.clear();
-			m_hub.Load(m_tilesetTexture, m_chunks, m_Player, m_chunkWidth, m_jerseyFont, m_windowSize);
+			m_hub.Load(m_tilesetAtlas, m_chunks, m_Player, m_chunkWidth, m_jerseyFont, m_windowSize);
+			m_collisionMap.rebuild(m_chunks);
+			m_chunkRenderer.rebuild(m_chunks, m_tilesetAtlas.getTexture());
 
 			m_screenEffect.initialize(m_windowSize);
 			m_screenEffect.initializeHubLighting(0.85f);
@@ -693,6 +714,8 @@ void Game::update(sf::Time t_deltaTime)
 			std::cout << "Attack Cooldown: " << fuzzyParams.attackCooldown << std::endl;
 			std::cout << "Spawn Rate: " << fuzzyParams.spawnRate << std::endl;
 			std::cout << "Attack Window: " << fuzzyParams.attackWindowSize << std::endl;
+			if (m_bpmStream.getTempoRatio() != 1.f)
+				std::cout << "Tempo Ratio: " << m_bpmStream.getTempoRatio() << " (stretch load " << m_bpmStream.getStretchLoad() * 100.f << "%)" << std::endl;
 			std::cout << "====================" << std::endl;
 		}
 
@@ -708,7 +731,7 @@ void Game::update(sf::Time t_deltaTime)
 					rightmostChunkX = chunkRight;
 			}
 
-			m_enemySpawnManager.Update(dt, m_Player.pos, m_enemies, m_archers, m_executioners, rightmostChunkX, m_chunks);
+			m_enemySpawnManager.Update(dt, m_Player.pos, m_enemies, m_archers, m_executioners, rightmostChunkX, m_collisionMap);
 			float hpRatio = static_cast<float>(m_Player.health) / m_Player.MAX_HEALTH;
 			hpRatio = std::clamp(hpRatio, 0.f, 1.f);
 
@@ -766,7 +789,7 @@ void Game::update(sf::Time t_deltaTime)
 				bool wouldFallOffLedge = EnemyCollision::IsLedgeAhead(
 					oldPos,  // Check from OLD position
 					enemy.facingRight,
-					m_chunks,
+					m_collisionMap,
 					45.f
 				);
 
@@ -782,19 +805,19 @@ void Game::update(sf::Time t_deltaTime)
 
 				}
 
-				// Apply horizontal collision ( doesnt work great for walls )
+				// Apply horizontal collision, swept from where the enemy started the frame
 				EnemyCollision::CheckHorizontalCollision(
 					enemy.pos,
 					enemy.velocity,
-					m_chunks,
-					dt
+					m_collisionMap,
+					oldPos.x
 				);
 
 				// Snap to ground (prevents floating) same issue with player where it cause bouncing 
 				EnemyCollision::ApplyGravityAndGround(
 					enemy.pos,
 					enemy.velocity,  // Pass velocity so gravity can update it
-					m_chunks,
+					m_collisionMap,
 					dt
 				);
 
@@ -822,6 +845,7 @@ void Game::update(sf::Time t_deltaTime)
 						m_Player.m_parryPowerHit = false;
 						int damage = static_cast<int>(1 * m_Player.m_damageMultiplier * damageMultiplier * parryBonus);
 						enemy.TakeDamage(damage);
+						m_bpmStream.playSfx(SfxMixer::Sfx::Hit);
 						std::cout << "Hit Damage " << damage << " Enemy HP: " << enemy.health << std::endl;
 
 						float knockbackDir = m_Player.facingRight ? 1.f : -1.f;
@@ -853,6 +877,7 @@ void Game::update(sf::Time t_deltaTime)
 					if (m_Player.canBlockEnemy)
 					{
 						std::cout << "Attack blocked!" << std::endl;
+						m_bpmStream.playSfx(SfxMixer::Sfx::Parry);
 						float knockbackDirection = (m_Player.pos.x > enemy.pos.x) ? 1.0f : -1.0f;
 						m_Player.velocity.x = knockbackDirection * 200.f;
 						if (m_Player.isOnGround)
@@ -891,7 +916,7 @@ void Game::update(sf::Time t_deltaTime)
 				bool wouldFallOffLedge = EnemyCollision::IsLedgeAhead(
 					oldPos,
 					archer.facingRight,
-					m_chunks,
+					m_collisionMap,
 					45.f
 				);
 
@@ -911,15 +936,15 @@ void Game::update(sf::Time t_deltaTime)
 				EnemyCollision::CheckHorizontalCollision(
 					archer.pos,
 					archer.velocity,
-					m_chunks,
-					dt
+					m_collisionMap,
+					oldPos.x
 				);
 
 				// Snap to ground
 				EnemyCollision::ApplyGravityAndGround(
 					archer.pos,
 					archer.velocity,  // Pass velocity so gravity can update it
-					m_chunks,
+					m_collisionMap,
 					dt
 				);
 
@@ -943,6 +968,7 @@ void Game::update(sf::Time t_deltaTime)
 					arrowStart.x += archer.facingRight ? 40.f : -40.f;
 					m_arrows.emplace_back(arrowStart, archer.facingRight);
 					archer.hasDealtDamage = true;
+					m_bpmStream.playSfx(SfxMixer::Sfx::Arrow, SfxMixer::Quantize::NextHalfBeat, 0.7f);
 					std::cout << "Archer shot arrow!" << std::endl;
 				}
 
@@ -971,6 +997,7 @@ void Game::update(sf::Time t_deltaTime)
 					{
 						int damage = static_cast<int>(1 * m_Player.m_damageMultiplier);
 						archer.TakeDamage(damage);
+						m_bpmStream.playSfx(SfxMixer::Sfx::Hit);
 
 						float knockbackDir = m_Player.facingRight ? 1.f : -1.f;
 						archer.velocity.x = knockbackDir * 150.f;  
@@ -1019,7 +1046,7 @@ void Game::update(sf::Time t_deltaTime)
 					bool wouldFallOffLedge = EnemyCollision::IsLedgeAhead(
 						oldPos,
 						executioner.facingRight,
-						m_chunks,
+						m_collisionMap,
 						45.f
 					);
 
@@ -1031,8 +1058,8 @@ void Game::update(sf::Time t_deltaTime)
 						executioner.pos.x += executioner.velocity.x * dt;
 					}
 
-					EnemyCollision::CheckHorizontalCollision(executioner.pos, executioner.velocity, m_chunks, dt);
-					EnemyCollision::ApplyGravityAndGround(executioner.pos, executioner.velocity, m_chunks, dt);
+					EnemyCollision::CheckHorizontalCollision(executioner.pos, executioner.velocity, m_collisionMap, oldPos.x);
+					EnemyCollision::ApplyGravityAndGround(executioner.pos, executioner.velocity, m_collisionMap, dt);
 				}
 
 				if (executioner.sprite)
@@ -1058,6 +1085,7 @@ void Game::update(sf::Time t_deltaTime)
 						m_Player.m_parryPowerHit = false;
 						int damage = static_cast<int>(1 * m_Player.m_damageMultiplier * damageMultiplier * parryBonus);
 						executioner.TakeDamage(damage);
+						m_bpmStream.playSfx(SfxMixer::Sfx::Hit);
 						std::cout << "Hit Executioner! Damage: " << damage << " HP: " << executioner.health << std::endl;
 
 						float knockbackDir = m_Player.facingRight ? 1.f : -1.f;
@@ -1096,6 +1124,7 @@ void Game::update(sf::Time t_deltaTime)
 						if (m_Player.canBlockEnemy)
 						{
 							std::cout << "Executioner attack BLOCKED!" << std::endl;
+							m_bpmStream.playSfx(SfxMixer::Sfx::Parry);
 							float knockbackDirection = (m_Player.pos.x > executioner.pos.x) ? 1.0f : -1.0f;
 							m_Player.velocity.x = knockbackDirection * 350.f;
 							if (m_Player.isOnGround)
@@ -1138,6 +1167,7 @@ void Game::update(sf::Time t_deltaTime)
 					if (m_Player.canBlockEnemy)
 					{
 						std::cout << "Arrow blocked!" << std::endl;
+						m_bpmStream.playSfx(SfxMixer::Sfx::Parry);
 						arrow.active = false;
 					}
 					else
@@ -1208,7 +1238,7 @@ void Game::render()
 		if (m_isInHub)
 		{
 			// USE HUB CLASS TO RENDER
-			m_hub.Render(m_window, m_chunks, m_Player, m_cameraOffset,
+			m_hub.Render(m_window, m_chunks, m_chunkRenderer, m_Player, m_cameraOffset,
 				m_showDebugCollision, PLAYER_HITBOX_WIDTH, PLAYER_HITBOX_HEIGHT);
 
 			// Switch to default view FIRST
@@ -1249,9 +1279,8 @@ void Game::render()
 			// Render background
 			m_dynamicBackground.render(m_window);
 
-			// Render chunks
-			for (auto& chunk : m_chunks)
-				chunk.draw(m_window, m_cameraOffset);
+			// Render chunks, only the columns in view
+			m_chunkRenderer.draw(m_window, m_cameraOffset);
 
 			// Debug collision
 			if (m_showDebugCollision)
@@ -1545,6 +1574,11 @@ void Game::setupAudio()
 	};
 	m_currentSongIndex = 0;
 
+	// Sound effects are mixed into the music stream, load them before the first song
+	m_bpmStream.loadSfx(SfxMixer::Sfx::Hit, "ASSETS/AUDIO/SFX/hit.wav");
+	m_bpmStream.loadSfx(SfxMixer::Sfx::Parry, "ASSETS/AUDIO/SFX/parry.wav");
+	m_bpmStream.loadSfx(SfxMixer::Sfx::Arrow, "ASSETS/AUDIO/SFX/arrow.wav");
+
 	std::cout << "Loading audio file..." << std::endl;
 
 	if (!m_bpmStream.load(m_songPaths[m_currentSongIndex]))
@@ -1560,6 +1594,70 @@ void Game::setupAudio()
 }
 
 
+// Moves the player by delta, stopping at the first wall on x and landing on
+// the first floor on the way down. Rising is left free so platforms can be
+// jumped through from below, like the feet-only ground check always allowed
+void Game::movePlayerSwept(sf::Vector2f delta)
+{
+	if (delta.x != 0.f)
+	{
+		sf::FloatRect playerBox(
+			{ m_Player.pos.x - PLAYER_HITBOX_WIDTH / 2.f, m_Player.pos.y - PLAYER_HITBOX_HEIGHT / 10.f },
+			{ PLAYER_HITBOX_WIDTH, PLAYER_HITBOX_HEIGHT }
+		);
+
+		CollisionMap::SweepHit hit = m_collisionMap.sweep(playerBox, { delta.x, 0.f });
+		m_Player.pos.x += delta.x * hit.time;
+		if (hit.hit)
+			m_Player.velocity.x = 0;
+	}
+
+	if (delta.y > 0.f)
+	{
+		// Feet point, same spot the ground check uses
+		sf::FloatRect feet({ m_Player.pos.x, m_Player.pos.y + 50.f }, { 0.f, 0.f });
+		CollisionMap::SweepHit hit = m_collisionMap.sweep(feet, { 0.f, delta.y });
+		m_Player.pos.y += delta.y * hit.time;
+		if (hit.hit)
+		{
+			m_Player.isOnGround = true;
+			m_Player.velocity.y = 0;
+		}
+	}
+	else
+	{
+		m_Player.pos.y += delta.y;
+	}
+
+	if (m_Player.sprite)
+		m_Player.sprite->setPosition(m_Player.pos);
+}
+
+bool Game::setWorldTile(sf::Vector2f worldPos, uint16_t id)
+{
+	for (Chunk& chunk : m_chunks)
+	{
+		const ChunkTemplate* tmpl = chunk.getTemplate();
+		if (!tmpl)
+			continue;
+
+		sf::Vector2f local = worldPos - chunk.getPosition();
+		int x = static_cast<int>(std::floor(local.x / tmpl->tileSize));
+		int y = static_cast<int>(std::floor(local.y / tmpl->tileSize));
+		if (x < 0 || x >= tmpl->width || y < 0 || y >= tmpl->height)
+			continue;
+
+		if (!chunk.setTile(x, y, id))
+			return false;
+
+		// Just this tile's column and vertices, the upload waits for the draw
+		m_collisionMap.updateColumn(chunk, x);
+		m_chunkRenderer.setTile(chunk, x, y);
+		return true;
+	}
+	return false;
+}
+
 void Game::updateChunks()
 {
 	float viewWidth = m_gameView.getSize().x;
@@ -1606,28 +1704,48 @@ void Game::updateChunks()
 		}
 	}
 
-	float scrollTrigger = m_gameView.getCenter().x + viewWidth * 0.6f;
-	if (m_Player.pos.x > scrollTrigger)
-	{
-		// Find leftmost chunk
-		float leftmostX = 999999.0f;
-		int leftmostIndex = 0;
+	// Find leftmost chunk
+	float leftmostX = 999999.0f;
+	int leftmostIndex = 0;
 
-		for (int i = 0; i < m_chunks.size(); ++i)
+	for (int i = 0; i < m_chunks.size(); ++i)
+	{
+		if (m_chunks[i].getPosition().x < leftmostX)
 		{
-			if (m_chunks[i].getPosition().x < leftmostX)
-			{
-				leftmostX = m_chunks[i].getPosition().x;
-				leftmostIndex = i;
-			}
+			leftmostX = m_chunks[i].getPosition().x;
+			leftmostIndex = i;
 		}
+	}
+
+	float scrollTrigger = m_gameView.getCenter().x + viewWidth * 0.6f;
+	float recycleX = leftmostX + m_chunkWidth * 2.0f;
+
+	// Let the streamer get the next chunk ready before the player reaches the recycle point
+	m_chunkStreamer.update(std::max(scrollTrigger, recycleX) - m_Player.pos.x, m_Player.velocity.x);
 
-		// Only recycle if leftmost is  behind playe
-		if (m_Player.pos.x > leftmostX + m_chunkWidth * 2.0f )
+	// Only recycle if leftmost is  behind playe
+	if (m_Player.pos.x > scrollTrigger && m_Player.pos.x > recycleX)
+	{
+		float newX = rightmostX;
+		m_collisionMap.removeChunk(m_chunks[leftmostIndex]);
+		m_chunkRenderer.removeChunk(m_chunks[leftmostIndex]);
+		ChunkStreamer::Prepared next;
+		if (m_chunkStreamer.takeNext(next))
+		{
+			// Decoded and built on the worker, the mesh and collision columns are only copied in
+			m_chunks[leftmostIndex].setTemplate(std::move(next.chunk), m_tilesetAtlas.getTexture());
+			m_chunks[leftmostIndex].setPosition(sf::Vector2f(newX, 190.0f));
+			m_collisionMap.placeChunk(m_chunks[leftmostIndex], next.solidColumns);
+			m_chunkRenderer.placeChunk(m_chunks[leftmostIndex], next.mesh);
+		}
+		else
 		{
-			float newX = rightmostX;
+			// Worker hasn't caught up, load and build it here
 			loadChunkAt(leftmostIndex, newX);
+			m_collisionMap.placeChunk(m_chunks[leftmostIndex]);
+			m_chunkRenderer.placeChunk(m_chunks[leftmostIndex]);
 		}
+		m_chunkTransitionThisFrame = true;
 	}
 }
 
@@ -1641,7 +1759,7 @@ bool Game::loadChunkAt(int index, float xPosition)
 
 	std::string tilesetPath = DynamicBackground::GetTilesetPath(m_currentGameTheme);
 
-	if (!m_chunks[index].load(chunkFile, m_tilesetTexture, 32, tilesetPath))
+	if (!m_chunks[index].load(chunkFile, m_tilesetAtlas.getTexture(), 32, tilesetPath, m_tilesetAtlas.getRegion(m_currentGameTheme)))
 	{
 		std::cout << "Failed to load chunk at index " << index << std::endl;
 		return false;
@@ -1653,6 +1771,110 @@ bool Game::loadChunkAt(int index, float xPosition)
 	return true;
 }
 
+void Game::applyAssetReloads()
+{
+	bool chunksChanged = false;
+	for (const AssetWatcher::Reload& reload : m_assetWatcher.takeReloads())
+	{
+		// The streamer's prepared chunk may be from before the reload
+		if (!reload.templates.empty())
+			m_chunkStreamer.invalidate();
+
+		if (reload.isShader)
+		{
+			if (!m_chunkRenderer.reloadShader(reload.path, reload.shaderSource)
+				&& !m_screenEffect.reloadShader(reload.path, reload.shaderSource))
+				std::cout << "Hot reload: nothing uses " << reload.path << std::endl;
+			continue;
+		}
+
+		// Decoded on the watcher thread, placing is just a pointer swap. Tile
+		// edits made with setTile are dropped with the old template
+		for (Chunk& chunk : m_chunks)
+		{
+			const ChunkTemplate* placed = chunk.getTemplate();
+			for (const auto& reloaded : reload.templates)
+			{
+				if (placed && placed->sameSource(*reloaded))
+				{
+					chunk.setTemplate(reloaded, m_tilesetAtlas.getTexture());
+					chunksChanged = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (chunksChanged)
+	{
+		m_collisionMap.rebuild(m_chunks);
+		m_chunkRenderer.rebuild(m_chunks, m_tilesetAtlas.getTexture());
+	}
+}
+
+void Game::streamChunkTheme()
+{
+	const int TILE_SIZE = 32;
+	m_chunkStreamer.setSource(DynamicBackground::GetChunkPaths(m_currentGameTheme), TILE_SIZE,
+		DynamicBackground::GetTilesetPath(m_currentGameTheme), m_tilesetAtlas.getRegion(m_currentGameTheme));
+}
+
+// Frames that swapped a chunk in go in their own histogram so a load spike stands out
+void Game::recordFrameTime(float ms)
+{
+	if (!m_isInHub)
+	{
+		if (m_chunkTransitionThisFrame)
+			m_chunkTransitionFrameTimes.record(ms);
+		else
+			m_frameTimes.record(ms);
+	}
+	m_chunkTransitionThisFrame = false;
+}
+
+void Game::reportFrameTimes()
+{
+	if (m_frameTimes.count() == 0)
+		return;
+
+	ChunkStreamer::Stats stats = m_chunkStreamer.getStats();
+	std::cout << "=== FRAME TIMES ===" << std::endl;
+	std::cout << m_frameTimes.summary("Normal frames") << std::endl;
+	std::cout << m_chunkTransitionFrameTimes.summary("Chunk transition frames") << std::endl;
+	std::cout << "Chunk streamer: " << stats.hits << " prepared swaps, " << stats.misses << " main thread loads, "
+		<< stats.prepared << " prepared (avg " << stats.avgPrepareUs << "us, max " << stats.maxPrepareUs << "us)" << std::endl;
+
+	ChunkRenderer::Stats rendered = m_chunkRenderer.takeStats();
+	if (rendered.frames > 0)
+	{
+		std::cout << "Chunk vertices per frame: " << rendered.submittedVertices / rendered.frames << " in "
+			<< static_cast<float>(rendered.drawCalls) / rendered.frames << " draw calls, was "
+			<< rendered.loadedVertices / rendered.frames << " in " << rendered.chunkDraws / rendered.frames << " draw calls"
+			<< " (culled to the view's columns)" << std::endl;
+		std::cout << "Chunk submission: " << rendered.submitUs / rendered.frames << "us per frame, "
+			<< rendered.submitUs / std::max<unsigned long long>(rendered.chunkDraws, 1) << "us per loaded chunk ("
+			<< rendered.bufferFrames << "/" << rendered.frames << " frames from the vertex buffer)" << std::endl;
+	}
+	if (rendered.placedChunks > 0)
+		std::cout << "Chunk recycles: " << rendered.placedChunks << " appended to the mesh without a rebuild" << std::endl;
+	if (rendered.patchedTiles > 0 || rendered.editRebuilds > 0)
+	{
+		std::cout << "Tile edits: " << rendered.patchedTiles << " patched in place in " << rendered.patchUploads
+			<< " uploads, " << rendered.editRebuilds << " needed a rebuild" << std::endl;
+	}
+
+	std::size_t placedBytes = 0;
+	for (const auto& chunk : m_chunks)
+		if (chunk.getTemplate())
+			placedBytes += chunk.getTemplate()->memoryBytes();
+	std::cout << "Chunk memory: " << ChunkTemplateCache::size() << " templates, " << ChunkTemplateCache::memoryBytes() / 1024
+		<< " KB cached, " << placedBytes / 1024 << " KB behind the " << m_chunks.size() << " placed chunks" << std::endl;
+
+
+	m_frameTimes.reset();
+	m_chunkTransitionFrameTimes.reset();
+}
+
 void Game::awardXP(float amount)
 {
 	m_playerXP += amount;
@@ -3,6 +3,10 @@
 
 #include <SFML/Audio.hpp>
 #include "BPM.h" // include of bpm stream of music
+#include "SfxMixer.h"
+#include "TimeStretcher.h"
+#include "MappedFile.h"
+#include <atomic>
 #include <vector>
 #include <string>
 
@@ -17,20 +21,46 @@ public:
     double getCurrentBPM() const;
     void reset();
 
+    // Sound effects mixed into the music on the audio thread
+    bool loadSfx(SfxMixer::Sfx id, const std::string& filename);
+    void playSfx(SfxMixer::Sfx id, SfxMixer::Quantize when = SfxMixer::Quantize::Now, float volume = 1.f);
+
+    // Tempo change without pitch shift, 1.0 plays the file verbatim
+    void setTempoRatio(float ratio);
+    float getTempoRatio() const;
+    // Fraction of the audio callback budget spent stretching (smoothed)
+    float getStretchLoad() const;
+
 protected:
     virtual bool onGetData(Chunk& data) override;
     virtual void onSeek(sf::Time timeOffset) override;
 
 private:
+    static constexpr std::size_t CHUNK_SIZE = 8192;
+
+    bool loadMappedWav(const std::string& filename);
+
+    // PCM WAVs are mapped and played in place, anything else is decoded into m_buffer
+    MappedFile m_file;
     sf::SoundBuffer m_buffer;
     const int16_t* m_samples = nullptr;
     size_t m_totalSamples = 0;
     size_t m_offset = 0;
+    unsigned int m_sampleRate = 0;
+    unsigned int m_channelCount = 0;
     mybpm::MiniBPM m_bpmDetector{ 44100.0f };
     double m_currentBpm = 0.0;
 
     std::vector<float> m_floatBuffer; // pre allocation 
     int m_chunkCounter = 0;
+
+    SfxMixer m_sfx;
+    std::vector<std::int16_t> m_mixBuffer; // music + sfx, handed to onGetData when voices are playing
+
+    TimeStretcher m_stretcher;
+    std::atomic<float> m_tempoRatio{ 1.f };  // set by the game thread
+    std::atomic<float> m_stretchLoad{ 0.f }; // written by the audio thread
+    bool m_stretching = false;               // audio thread only
 };
 
 #endif
\ No newline at end of file
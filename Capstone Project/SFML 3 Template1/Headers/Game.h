@@ -29,6 +29,7 @@
 #include "SkillTree.h"
 #include "Menu.h"
 #include "SpotifyClient.h"
+#include "SpotifyBridge.h"
 #include "EnemySpawnManager.h"
 #include "Debug.h"
 #include "EnemyCollision.h"
@@ -38,6 +39,12 @@
 #include "FuzzyBpmController.h"
 #include "Enemy3.h"
 #include "BossPool.h"
+#include "ChunkStreamer.h"
+#include "TilesetAtlas.h"
+#include "CollisionMap.h"
+#include "ChunkRenderer.h"
+#include "AssetWatcher.h"
+#include "FrameTimeHistogram.h"
 #include <memory>
 
 
@@ -87,6 +94,7 @@ private:
 	void setupTexts();
 	void setupSprites();
 	void setupAudio();
+	void startSpotifyBridge();
 
 	const float PLAYER_HITBOX_WIDTH = 30.f;
 	const float PLAYER_HITBOX_HEIGHT = 40.f;
@@ -98,22 +106,40 @@ private:
 
 	// Spotify
 	SpotifyClient m_spotifyClient;
+	SpotifyBridge m_spotifyBridge;
+	std::atomic<bool> m_spotifyBridgeReady{ false }; // set from the bridge thread, polling starts in update()
 	bool m_useSpotify = false;
+	float m_spotifyBeatOffsetMs = 0.f; // where the first beat falls, unless the bridge says (first_beat_ms)
 
 	sf::RenderWindow m_window; // main SFML window;
 	sf::Text m_formationHintText{ m_jerseyFont };
 
+	void movePlayerSwept(sf::Vector2f delta);  // Moves the player against m_collisionMap without tunnelling
 	void updateChunks();  //Manages chunk loading/unloading
+	bool setWorldTile(sf::Vector2f worldPos, uint16_t id);  // Changes one placed tile, patching collision and the merged mesh in place
 	bool loadChunkAt(int index, float xPosition);  // Loads chunk at position
+	void streamChunkTheme();  // Hands the current theme's chunks to the streamer, which decodes them off the main thread
+	ChunkStreamer m_chunkStreamer;
 	GameTheme m_currentGameTheme = GameTheme::Forest;
 	std::vector<Chunk> m_chunks;  // from single Chunk to vector
 	const int VISIBLE_CHUNKS = 3;  // NNumber of chunks to keep loaded
 	float m_chunkWidth = 640.0f;   // Width of each chunk (20 tiles * 32px)
 	int m_nextChunkIndex = 0;
-	sf::Texture m_tilesetTexture;
+	TilesetAtlas m_tilesetAtlas;  // all themes' tilesets, loaded once
+	CollisionMap m_collisionMap;  // solid tiles of m_chunks, rebuilt on load and patched on recycle
+	ChunkRenderer m_chunkRenderer;  // m_chunks' geometry merged for one culled draw, rebuilt with the collision map
+	AssetWatcher m_assetWatcher;  // reloads edited chunks, tilesets and shaders in the background
+	void applyAssetReloads();  // Swaps the watcher's finished reloads into the placed chunks and shaders
 
 	bool m_showDebugCollision = false;
 
+	// Frame time around chunk transitions, printed when a run ends
+	void recordFrameTime(float ms);
+	void reportFrameTimes();
+	FrameTimeHistogram m_frameTimes;
+	FrameTimeHistogram m_chunkTransitionFrameTimes;
+	bool m_chunkTransitionThisFrame = false;
+
 	float m_runStartX = 500.f;
 	float m_runLength = 1000.f;
 	float m_distanceTravelled = 0.f;
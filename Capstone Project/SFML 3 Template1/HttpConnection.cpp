@@ -0,0 +1,429 @@
+#include "HttpConnection.h"
+#include "NetSocket.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const std::size_t BUFFER_SIZE = 8192;
+    const int CONNECT_TIMEOUT_MS = 3000;
+    const int CONNECT_SLICE_MS = 20;    // how often a pending connect looks for interrupt()
+
+    double msSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool startsWithNoCase(const std::string& line, const char* prefix)
+    {
+        std::size_t len = std::strlen(prefix);
+        if (line.size() < len)
+            return false;
+        for (std::size_t i = 0; i < len; ++i)
+        {
+            if (std::tolower(static_cast<unsigned char>(line[i])) != prefix[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool containsNoCase(const std::string& line, const char* word)
+    {
+        std::string lower(line);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower.find(word) != std::string::npos;
+    }
+}
+
+void HttpConnection::initNetwork()
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+}
+
+void HttpConnection::shutdownNetwork()
+{
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+HttpConnection::HttpConnection(const std::string& host, unsigned short port)
+    : m_host(host)
+    , m_port(port)
+    , m_buffer(BUFFER_SIZE)
+{
+}
+
+HttpConnection::~HttpConnection()
+{
+    disconnect();
+}
+
+void HttpConnection::disconnect()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_socketMutex);
+        std::intptr_t sock = m_socket.exchange(-1);
+        if (sock != -1)
+            closeSocket(static_cast<SocketHandle>(sock));
+    }
+
+    m_readPos = 0;
+    m_dataEnd = 0;
+}
+
+void HttpConnection::interrupt()
+{
+    // shutdown wakes recv without freeing the handle under the owning thread. The
+    // lock keeps disconnect() from closing it (and the number being reused) meanwhile
+    std::lock_guard<std::mutex> lock(m_socketMutex);
+    m_interrupted = true;
+    std::intptr_t sock = m_socket.load();
+    if (sock != -1)
+        shutdownSocket(static_cast<SocketHandle>(sock));
+}
+
+void HttpConnection::clearInterrupt()
+{
+    std::lock_guard<std::mutex> lock(m_socketMutex);
+    m_interrupted = false;
+}
+
+HttpConnection::Stats HttpConnection::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+bool HttpConnection::connectSocket()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    SocketHandle sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == BAD_SOCKET)
+        return false;
+
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(m_port);
+    inet_pton(AF_INET, m_host.c_str(), &serverAddr.sin_addr);
+
+    // Non-blocking so interrupt() can cut a slow connect short (a full accept
+    // backlog costs a second per SYN retry), there is no socket to shut down yet
+    setBlocking(sock, false);
+    int connected = connect(sock, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) == 0 ? 1 : 0;
+    if (!connected && !connectInProgress())
+        connected = -1;
+
+    for (int waited = 0; connected == 0; waited += CONNECT_SLICE_MS)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_socketMutex);
+            if (m_interrupted || waited >= CONNECT_TIMEOUT_MS)
+                break;
+        }
+        connected = waitConnected(sock, CONNECT_SLICE_MS);
+    }
+
+    if (connected != 1)
+    {
+        closeSocket(sock);
+        return false;
+    }
+    setBlocking(sock, true);
+
+    // Small request/response pairs, don't wait on Nagle
+    int noDelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    // A stalled server must not hang the polling thread forever
+    ::setReceiveTimeout(sock, m_receiveTimeoutMs);
+
+    {
+        // An interrupt that came while connecting found no socket to shut down,
+        // so honour it here rather than block in the first receive
+        std::lock_guard<std::mutex> lock(m_socketMutex);
+        if (m_interrupted)
+        {
+            closeSocket(sock);
+            return false;
+        }
+        m_socket.store(static_cast<std::intptr_t>(sock));
+    }
+    m_readPos = 0;
+    m_dataEnd = 0;
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    ++m_stats.connects;
+    m_stats.lastConnectMs = msSince(start);
+    return true;
+}
+
+bool HttpConnection::sendAll(const char* data, std::size_t size)
+{
+    return ::sendAll(static_cast<SocketHandle>(m_socket.load()), data, size);
+}
+
+bool HttpConnection::get(const std::string& path, std::string& body)
+{
+    m_request.clear();
+    m_request += "GET ";
+    m_request += path;
+    m_request += " HTTP/1.1\r\nHost: ";
+    m_request += m_host;
+    m_request += "\r\nConnection: keep-alive\r\n\r\n";
+
+    // Second attempt covers the server having closed an idle keep-alive socket
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        bool reused = (m_socket != -1);
+        if (!reused && !connectSocket())
+            break;
+
+        auto start = std::chrono::steady_clock::now();
+        bool keepAlive = true;
+
+        if (sendAll(m_request.data(), m_request.size()) && readResponse(body, keepAlive))
+        {
+            if (!keepAlive)
+                disconnect();
+
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            double ms = msSince(start);
+            ++m_stats.requests;
+            m_stats.lastRequestMs = ms;
+            m_stats.maxRequestMs = std::max(m_stats.maxRequestMs, ms);
+            m_stats.avgRequestMs = (m_stats.requests == 1) ? ms : m_stats.avgRequestMs + (ms - m_stats.avgRequestMs) * 0.1;
+            return true;
+        }
+
+        disconnect();
+        if (!reused)
+            break; // fresh connection failed, retrying won't help
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    ++m_stats.failures;
+    return false;
+}
+
+bool HttpConnection::fill()
+{
+    // Compact what is left before reading more
+    if (m_readPos > 0)
+    {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_readPos, m_dataEnd - m_readPos);
+        m_dataEnd -= m_readPos;
+        m_readPos = 0;
+    }
+    if (m_dataEnd == m_buffer.size())
+        m_buffer.resize(m_buffer.size() * 2);
+
+    int received = recv(static_cast<SocketHandle>(m_socket.load()), m_buffer.data() + m_dataEnd,
+        static_cast<int>(m_buffer.size() - m_dataEnd), 0);
+    if (received <= 0)
+        return false;
+
+    m_dataEnd += static_cast<std::size_t>(received);
+    return true;
+}
+
+bool HttpConnection::readLine(std::string& line)
+{
+    for (;;)
+    {
+        const char* begin = m_buffer.data() + m_readPos;
+        const char* end = m_buffer.data() + m_dataEnd;
+        const char* newline = std::find(begin, end, '\n');
+        if (newline != end)
+        {
+            const char* lineEnd = (newline > begin && newline[-1] == '\r') ? newline - 1 : newline;
+            line.assign(begin, lineEnd);
+            m_readPos += static_cast<std::size_t>(newline - begin) + 1;
+            return true;
+        }
+        if (!fill())
+            return false;
+    }
+}
+
+bool HttpConnection::readBytes(std::size_t count, std::string& out)
+{
+    while (count > 0)
+    {
+        if (m_readPos == m_dataEnd && !fill())
+            return false;
+
+        std::size_t take = std::min(count, m_dataEnd - m_readPos);
+        out.append(m_buffer.data() + m_readPos, take);
+        m_readPos += take;
+        count -= take;
+    }
+    return true;
+}
+
+bool HttpConnection::readHeaders(long long& contentLength, bool& chunked, bool& keepAlive)
+{
+    // Status line: HTTP/1.1 200 OK
+    if (!readLine(m_line) || m_line.compare(0, 5, "HTTP/") != 0)
+        return false;
+
+    std::size_t space = m_line.find(' ');
+    m_lastStatus = (space != std::string::npos) ? std::atoi(m_line.c_str() + space + 1) : 0;
+    keepAlive = (m_line.compare(0, 8, "HTTP/1.0") != 0);
+
+    contentLength = -1;
+    chunked = false;
+
+    for (;;)
+    {
+        if (!readLine(m_line))
+            return false;
+        if (m_line.empty())
+            return true;
+
+        if (startsWithNoCase(m_line, "content-length:"))
+            contentLength = std::atoll(m_line.c_str() + 15);
+        else if (startsWithNoCase(m_line, "transfer-encoding:"))
+            chunked = containsNoCase(m_line, "chunked");
+        else if (startsWithNoCase(m_line, "connection:"))
+            keepAlive = !containsNoCase(m_line, "close");
+    }
+}
+
+bool HttpConnection::readResponse(std::string& body, bool& keepAlive)
+{
+    body.clear();
+
+    long long contentLength = -1;
+    bool chunked = false;
+
+    // Interim 1xx responses come ahead of the real one (RFC 9112 6.3)
+    do
+    {
+        if (!readHeaders(contentLength, chunked, keepAlive))
+            return false;
+    } while (m_lastStatus >= 100 && m_lastStatus < 200 && m_lastStatus != 101);
+
+    // These never have a body whatever the headers say; reading to close would
+    // sit out the receive timeout on a kept-alive socket. Only GETs are sent,
+    // so there is no HEAD response to allow for
+    if (m_lastStatus < 200 || m_lastStatus == 204 || m_lastStatus == 304)
+        return true;
+
+    if (chunked)
+    {
+        for (;;)
+        {
+            if (!readLine(m_line))
+                return false;
+
+            std::size_t size = std::strtoul(m_line.c_str(), nullptr, 16);
+            if (size == 0)
+            {
+                // Skip trailers up to the blank line
+                while (readLine(m_line) && !m_line.empty()) {}
+                return true;
+            }
+
+            if (!readBytes(size, body) || !readLine(m_line))
+                return false;
+        }
+    }
+
+    if (contentLength >= 0)
+        return readBytes(static_cast<std::size_t>(contentLength), body);
+
+    // No length given, body runs until the server closes
+    keepAlive = false;
+    for (;;)
+    {
+        body.append(m_buffer.data() + m_readPos, m_dataEnd - m_readPos);
+        m_readPos = m_dataEnd;
+        if (!fill())
+            return true;
+    }
+}
+
+bool HttpConnection::openStream(const std::string& path)
+{
+    disconnect();
+    if (!connectSocket())
+        return false;
+
+    m_request.clear();
+    m_request += "GET ";
+    m_request += path;
+    m_request += " HTTP/1.1\r\nHost: ";
+    m_request += m_host;
+    m_request += "\r\nAccept: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+
+    long long contentLength = -1;
+    bool keepAlive = true;
+    if (!sendAll(m_request.data(), m_request.size())
+        || !readHeaders(contentLength, m_streamChunked, keepAlive)
+        || m_lastStatus != 200)
+    {
+        disconnect();
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.failures;
+        return false;
+    }
+
+    m_chunkRemaining = 0;
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    ++m_stats.requests;
+    return true;
+}
+
+bool HttpConnection::readStreamByte(char& c)
+{
+    // Strip chunked framing so callers only see the event text
+    if (m_streamChunked && m_chunkRemaining == 0)
+    {
+        do
+        {
+            if (!readLine(m_line))
+                return false;
+        } while (m_line.empty()); // CRLF that ends the previous chunk
+
+        m_chunkRemaining = std::strtoul(m_line.c_str(), nullptr, 16);
+        if (m_chunkRemaining == 0)
+            return false; // server ended the stream
+    }
+
+    if (m_readPos == m_dataEnd && !fill())
+        return false;
+
+    c = m_buffer[m_readPos++];
+    if (m_streamChunked)
+        --m_chunkRemaining;
+    return true;
+}
+
+bool HttpConnection::readStreamLine(std::string& line)
+{
+    line.clear();
+    char c;
+    while (readStreamByte(c))
+    {
+        if (c == '\n')
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            return true;
+        }
+        line += c;
+    }
+
+    disconnect();
+    return false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Persistent HTTP/1.1 keep-alive connection to a single local host.
+// Reconnects transparently when the server drops the socket and parses
+// Content-Length and chunked bodies into a caller-owned, reused string.
+// Not thread-safe apart from getStats() and interrupt()
+class HttpConnection
+{
+public:
+    struct Stats
+    {
+        unsigned int connects = 0;
+        unsigned int requests = 0;
+        unsigned int failures = 0;
+        double lastConnectMs = 0.0;
+        double lastRequestMs = 0.0;
+        double avgRequestMs = 0.0;  // smoothed round trip, excludes connect
+        double maxRequestMs = 0.0;
+    };
+
+    HttpConnection(const std::string& host, unsigned short port);
+    ~HttpConnection();
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    // Returns false on network/protocol failure, body holds the response otherwise
+    bool get(const std::string& path, std::string& body);
+    void disconnect();
+
+    // Long-lived response (Server-Sent Events). openStream sends the request and
+    // reads the headers, readStreamLine then returns the body one line at a time
+    bool openStream(const std::string& path);
+    bool readStreamLine(std::string& line);
+
+    // Unblocks a pending receive from another thread, the owning thread sees a failure.
+    // Latched: connections opened afterwards fail too, until clearInterrupt()
+    void interrupt();
+    void clearInterrupt();
+    void setReceiveTimeout(int ms) { m_receiveTimeoutMs = ms; }
+
+    int getLastStatus() const { return m_lastStatus; }
+    Stats getStats() const;
+
+    static void initNetwork();
+    static void shutdownNetwork();
+
+private:
+    bool connectSocket();
+    bool sendAll(const char* data, std::size_t size);
+    bool readResponse(std::string& body, bool& keepAlive);
+    bool readHeaders(long long& contentLength, bool& chunked, bool& keepAlive);
+    bool readStreamByte(char& c);
+    bool readLine(std::string& line);
+    bool readBytes(std::size_t count, std::string& out);
+    bool fill();
+
+    std::string m_host;
+    unsigned short m_port;
+    std::atomic<std::intptr_t> m_socket{ -1 };
+    std::mutex m_socketMutex;   // held to close or store the socket, and by interrupt()
+    bool m_interrupted = false; // guarded by m_socketMutex
+    int m_receiveTimeoutMs = 3000;
+
+    // open stream state
+    bool m_streamChunked = false;
+    std::size_t m_chunkRemaining = 0;
+
+    std::string m_request;      // reused request text
+    std::string m_line;         // reused header line
+    std::vector<char> m_buffer; // receive buffer
+    std::size_t m_readPos = 0;
+    std::size_t m_dataEnd = 0;
+
+    int m_lastStatus = 0;
+
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;
+};
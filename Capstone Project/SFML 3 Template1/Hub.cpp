@@ -13,7 +13,7 @@ Hub::Hub()
 {
 }
 
-void Hub::Load(const sf::Texture& tileset,
+void Hub::Load(const TilesetAtlas& tilesets,
     std::vector<Chunk>& chunks,
     player& player,
     float& chunkWidth,
@@ -33,7 +33,7 @@ void Hub::Load(const sf::Texture& tileset,
 
     for (int i = 0; i < hubChunks.size(); ++i)
     {
-        if (!chunks[i].load(hubChunks[i], tileset, 32, hubTilesetPath))
+        if (!chunks[i].load(hubChunks[i], tilesets.getTexture(), 32, hubTilesetPath, tilesets.getRegion(GameTheme::Hub)))
         {
             std::cout << "Failed to load hub chunk " << i << std::endl;
             continue;
@@ -245,6 +245,7 @@ void Hub::CloseShop()
 void Hub::Render(
     sf::RenderWindow& window,
     std::vector<Chunk>& chunks,
+    ChunkRenderer& chunkRenderer,
     player& player,
     const sf::Vector2f& cameraOffset,
     bool showDebugCollision,
@@ -252,10 +253,7 @@ void Hub::Render(
     float PLAYER_HITBOX_HEIGHT)
 {
     // Render hub chunks
-    for (auto& chunk : chunks)
-    {
-        chunk.draw(window, cameraOffset);
-    }
+    chunkRenderer.draw(window, cameraOffset);
 
     m_portal.render(window, cameraOffset);
 
@@ -5,6 +5,8 @@
 #include <vector>
 #include <optional>
 #include "Chunk.h"
+#include "TilesetAtlas.h"
+#include "ChunkRenderer.h"
 #include "Headers/Player.h"
 #include "ShopUI.h"
 #include "Portal.h"
@@ -16,7 +18,7 @@ public:
     Hub();
     void HandleResize(const sf::Vector2u& newSize);
 
-    void Load(const sf::Texture& tileset, 
+    void Load(const TilesetAtlas& tilesets, 
         std::vector<Chunk>& chunks, 
         player& player, float& chunkWidth, 
         const sf::Font& font, 
@@ -27,6 +29,7 @@ public:
     void Render(
         sf::RenderWindow& window,
         std::vector<Chunk>& chunks,
+        ChunkRenderer& chunkRenderer,
         player& player,
         const sf::Vector2f& cameraOffset,
         bool showDebugCollision,
@@ -0,0 +1,88 @@
+#pragma once
+// Thin BSD/Winsock portability layer, include from .cpp files only
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+using SocketHandle = SOCKET;
+static const SocketHandle BAD_SOCKET = INVALID_SOCKET;
+static const int SEND_FLAGS = 0;
+inline void closeSocket(SocketHandle s) { closesocket(s); }
+inline void shutdownSocket(SocketHandle s) { shutdown(s, SD_BOTH); }
+inline void setBlocking(SocketHandle s, bool blocking) { u_long mode = blocking ? 0 : 1; ioctlsocket(s, FIONBIO, &mode); }
+inline bool connectInProgress() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+using SocketHandle = int;
+static const SocketHandle BAD_SOCKET = -1;
+static const int SEND_FLAGS = MSG_NOSIGNAL; // a dropped keep-alive socket must not raise SIGPIPE
+inline void closeSocket(SocketHandle s) { ::close(s); }
+inline void shutdownSocket(SocketHandle s) { shutdown(s, SHUT_RDWR); }
+inline void setBlocking(SocketHandle s, bool blocking)
+{
+    int flags = fcntl(s, F_GETFL, 0);
+    fcntl(s, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+}
+inline bool connectInProgress() { return errno == EINPROGRESS; }
+#endif
+
+#include <cstddef>
+
+inline void setReceiveTimeout(SocketHandle s, int ms)
+{
+#ifdef _WIN32
+    DWORD timeout = ms;
+#else
+    timeval timeout{ ms / 1000, (ms % 1000) * 1000 };
+#endif
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+// Waits up to ms for a non-blocking connect to finish: 1 connected, 0 still
+// connecting, -1 failed
+inline int waitConnected(SocketHandle s, int ms)
+{
+#ifdef _WIN32
+    fd_set writable, failed;
+    FD_ZERO(&writable);
+    FD_ZERO(&failed);
+    FD_SET(s, &writable);
+    FD_SET(s, &failed);
+    timeval timeout{ ms / 1000, (ms % 1000) * 1000 };
+    int ready = select(0, nullptr, &writable, &failed, &timeout);
+#else
+    pollfd pfd{ s, POLLOUT, 0 };
+    int ready = poll(&pfd, 1, ms);
+#endif
+    if (ready < 0)
+        return -1;
+    if (ready == 0)
+        return 0;
+
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+    return error == 0 ? 1 : -1;
+}
+
+inline bool sendAll(SocketHandle s, const char* data, std::size_t size)
+{
+    while (size > 0)
+    {
+        int sent = send(s, data, static_cast<int>(size), SEND_FLAGS);
+        if (sent <= 0)
+            return false;
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
@@ -6,6 +6,12 @@
 #include <iostream>
 #include <cmath>
 
+namespace
+{
+    const std::string VIGNETTE_SHADER = "ASSETS/Shaders/expedition_vignette.frag";
+    const std::string HUB_LIGHTING_SHADER = "ASSETS/Shaders/hub_lighting.frag";
+}
+
 ScreenEffect::ScreenEffect()
     : m_shaderLoaded(false)
     , m_hubLightingLoaded(false)
@@ -34,7 +40,7 @@ bool ScreenEffect::initialize(sf::Vector2u windowSize)
     }
 
     // Load the expedition vignette shader
-    if (!m_vignetteShader.loadFromFile("ASSETS/Shaders/expedition_vignette.frag", sf::Shader::Type::Fragment))
+    if (!m_vignetteShader.loadFromFile(VIGNETTE_SHADER, sf::Shader::Type::Fragment))
     {
         std::cout << "Failed to load expedition vignette shader - using fallback" << std::endl;
         m_shaderLoaded = false;
@@ -81,7 +87,7 @@ bool ScreenEffect::initializeHubLighting(float ambientDarkness)
     }
 
     // Load the hub lighting shader
-    if (!m_hubLightingShader.loadFromFile("ASSETS/Shaders/hub_lighting.frag", sf::Shader::Type::Fragment))
+    if (!m_hubLightingShader.loadFromFile(HUB_LIGHTING_SHADER, sf::Shader::Type::Fragment))
     {
         std::cout << "Failed to load hub lighting shader" << std::endl;
         m_hubLightingLoaded = false;
@@ -98,6 +104,38 @@ bool ScreenEffect::initializeHubLighting(float ambientDarkness)
     return true;
 }
 
+bool ScreenEffect::reloadShader(const std::string& path, const std::string& source)
+{
+    bool vignette = path == VIGNETTE_SHADER;
+    if ((!vignette && path != HUB_LIGHTING_SHADER) || !sf::Shader::isAvailable())
+        return false;
+
+    // Compile aside so a broken edit leaves the running shader alone
+    sf::Shader compiled;
+    if (!compiled.loadFromMemory(source, sf::Shader::Type::Fragment))
+    {
+        std::cout << "Failed to compile " << path << " - keeping the old shader" << std::endl;
+        return true;
+    }
+
+    if (vignette)
+    {
+        m_vignetteShader = std::move(compiled);
+        m_shaderLoaded = true;
+        m_vignetteShader.setUniform("u_resolution", m_fullscreenQuad.getSize());
+        updateVignetteShader();
+    }
+    else
+    {
+        // render() sets every hub lighting uniform each frame
+        m_hubLightingShader = std::move(compiled);
+        m_hubLightingLoaded = true;
+    }
+
+    std::cout << "Reloaded " << path << std::endl;
+    return true;
+}
+
 void ScreenEffect::setMode(Mode mode)
 {
     m_currentMode = mode;
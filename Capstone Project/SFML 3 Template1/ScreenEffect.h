@@ -8,6 +8,7 @@
 
 #include <SFML/Graphics.hpp>
 #include <memory>
+#include <string>
 
 class ScreenEffect
 {
@@ -55,6 +56,7 @@ public:
 
     void setVignetteParams(sf::Vector3f color, float intensity, float softness = 0.5f);
     bool initializeHubLighting(float ambientDarkness = 0.9f);
+    bool reloadShader(const std::string& path, const std::string& source);  // hot reload, false if not one of ours
     void updatePlayerLight(sf::Vector2f playerScreenPosition);
     void setHubLightParams(float range, sf::Color color = sf::Color(255, 220, 180));
 
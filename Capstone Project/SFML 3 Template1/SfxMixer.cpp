@@ -0,0 +1,209 @@
+#include "SfxMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool SfxMixer::loadSound(Sfx id, const std::string& filename)
+{
+    Clip& clip = m_clips[static_cast<std::size_t>(id)];
+    clip.loaded = clip.source.loadFromFile(filename);
+    if (!clip.loaded)
+    {
+        std::cerr << "Failed to load sound effect: " << filename << std::endl;
+        clip.converted.clear();
+        clip.frameCount = 0;
+        return false;
+    }
+
+    // Stream format already known, convert straight away
+    if (m_sampleRate > 0)
+        convertClip(clip);
+
+    return true;
+}
+
+void SfxMixer::prepare(unsigned int sampleRate, unsigned int channelCount)
+{
+    m_sampleRate = sampleRate;
+    m_channelCount = channelCount;
+
+    for (auto& clip : m_clips)
+    {
+        if (clip.loaded)
+            convertClip(clip);
+    }
+
+    reset();
+}
+
+void SfxMixer::reset()
+{
+    clearVoices();
+    m_queueTail.store(m_queueHead.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// Resample + remap channels once at load so the audio thread only adds samples
+void SfxMixer::convertClip(Clip& clip)
+{
+    const std::int16_t* src = clip.source.getSamples();
+    unsigned int srcChannels = clip.source.getChannelCount();
+    unsigned int srcRate = clip.source.getSampleRate();
+
+    clip.converted.clear();
+    clip.frameCount = 0;
+
+    if (!src || srcChannels == 0 || srcRate == 0 || m_channelCount == 0)
+        return;
+
+    std::size_t srcFrames = static_cast<std::size_t>(clip.source.getSampleCount()) / srcChannels;
+    double step = static_cast<double>(srcRate) / m_sampleRate;
+    std::size_t dstFrames = static_cast<std::size_t>(srcFrames / step);
+
+    clip.converted.resize(dstFrames * m_channelCount);
+
+    for (std::size_t i = 0; i < dstFrames; ++i)
+    {
+        double srcPos = i * step;
+        std::size_t i0 = static_cast<std::size_t>(srcPos);
+        std::size_t i1 = std::min(i0 + 1, srcFrames - 1);
+        float frac = static_cast<float>(srcPos - i0);
+
+        for (unsigned int c = 0; c < m_channelCount; ++c)
+        {
+            float a, b;
+            if (srcChannels == 1)
+            {
+                a = src[i0];
+                b = src[i1];
+            }
+            else if (m_channelCount == 1)
+            {
+                // downmix to mono
+                a = (src[i0 * srcChannels] + src[i0 * srcChannels + 1]) * 0.5f;
+                b = (src[i1 * srcChannels] + src[i1 * srcChannels + 1]) * 0.5f;
+            }
+            else
+            {
+                unsigned int sc = std::min(c, srcChannels - 1);
+                a = src[i0 * srcChannels + sc];
+                b = src[i1 * srcChannels + sc];
+            }
+            clip.converted[i * m_channelCount + c] = static_cast<std::int16_t>(a + (b - a) * frac);
+        }
+    }
+
+    clip.frameCount = dstFrames;
+}
+
+bool SfxMixer::trigger(Sfx id, Quantize when, float volume)
+{
+    unsigned int head = m_queueHead.load(std::memory_order_relaxed);
+    unsigned int tail = m_queueTail.load(std::memory_order_acquire);
+
+    if (head - tail >= QUEUE_SIZE)
+        return false; // audio thread is behind, drop the event
+
+    Event& e = m_queue[head & (QUEUE_SIZE - 1)];
+    e.id = id;
+    e.when = when;
+    e.volume = std::clamp(volume, 0.f, 1.f);
+
+    m_queueHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool SfxMixer::hasWork() const
+{
+    return m_activeVoices > 0
+        || m_queueHead.load(std::memory_order_acquire) != m_queueTail.load(std::memory_order_relaxed);
+}
+
+void SfxMixer::clearVoices()
+{
+    for (auto& voice : m_voices)
+        voice.active = false;
+    m_activeVoices = 0;
+}
+
+void SfxMixer::startVoice(const Event& e, double beatPosition, double framesPerBeat)
+{
+    const Clip& clip = m_clips[static_cast<std::size_t>(e.id)];
+    if (clip.frameCount == 0)
+        return;
+
+    // Delay in frames from the start of the current chunk to the requested grid line
+    double delay = 0.0;
+    if (e.when != Quantize::Now && framesPerBeat > 0.0)
+    {
+        double grid = (e.when == Quantize::NextBeat) ? 1.0 : 0.5;
+        double next = std::ceil(beatPosition / grid) * grid;
+        delay = (next - beatPosition) * framesPerBeat;
+    }
+
+    // Free voice first, otherwise steal the one that has played longest
+    Voice* target = nullptr;
+    for (auto& voice : m_voices)
+    {
+        if (!voice.active)
+        {
+            target = &voice;
+            ++m_activeVoices;
+            break;
+        }
+        if (!target || voice.position > target->position)
+            target = &voice;
+    }
+
+    target->samples = clip.converted.data();
+    target->frameCount = clip.frameCount;
+    target->position = 0;
+    target->delay = static_cast<std::size_t>(delay + 0.5);
+    target->gain = static_cast<std::int32_t>(e.volume * 32767.f);
+    target->active = true;
+}
+
+void SfxMixer::mix(std::int16_t* samples, std::size_t frameCount, double beatPosition, double framesPerBeat)
+{
+    // Pick up everything the game thread queued since the last chunk
+    unsigned int tail = m_queueTail.load(std::memory_order_relaxed);
+    unsigned int head = m_queueHead.load(std::memory_order_acquire);
+    while (tail != head)
+    {
+        startVoice(m_queue[tail & (QUEUE_SIZE - 1)], beatPosition, framesPerBeat);
+        ++tail;
+    }
+    m_queueTail.store(tail, std::memory_order_release);
+
+    for (auto& voice : m_voices)
+    {
+        if (!voice.active)
+            continue;
+
+        if (voice.delay >= frameCount)
+        {
+            voice.delay -= frameCount;
+            continue;
+        }
+
+        std::size_t start = voice.delay;
+        voice.delay = 0;
+
+        std::size_t frames = std::min(frameCount - start, voice.frameCount - voice.position);
+        std::int16_t* out = samples + start * m_channelCount;
+        const std::int16_t* in = voice.samples + voice.position * m_channelCount;
+        std::size_t count = frames * m_channelCount;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::int32_t s = out[i] + ((in[i] * voice.gain) >> 15);
+            out[i] = static_cast<std::int16_t>(std::clamp(s, -32768, 32767));
+        }
+
+        voice.position += frames;
+        if (voice.position >= voice.frameCount)
+        {
+            voice.active = false;
+            --m_activeVoices;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fixed-voice sound effect mixer that runs inside BpmStream::onGetData.
+// The game thread queues events, the audio thread places them at exact
+// sample offsets on the music timeline. Nothing allocates once playing
+class SfxMixer
+{
+public:
+    enum class Sfx
+    {
+        Hit,
+        Parry,
+        Arrow,
+        Count
+    };
+
+    // When a queued event should start on the music timeline
+    enum class Quantize
+    {
+        Now,
+        NextBeat,
+        NextHalfBeat
+    };
+
+    static constexpr int MAX_VOICES = 16;
+    static constexpr unsigned int QUEUE_SIZE = 64; // power of two
+
+    // Setup (game thread, stream stopped)
+    bool loadSound(Sfx id, const std::string& filename);
+    void prepare(unsigned int sampleRate, unsigned int channelCount);
+    void reset();
+
+    // Game thread - returns false if the event queue is full
+    bool trigger(Sfx id, Quantize when = Quantize::Now, float volume = 1.f);
+
+    // Audio thread
+    bool hasWork() const;
+    void mix(std::int16_t* samples, std::size_t frameCount, double beatPosition, double framesPerBeat);
+    void clearVoices();
+
+private:
+    struct Event
+    {
+        Sfx id = Sfx::Hit;
+        Quantize when = Quantize::Now;
+        float volume = 1.f;
+    };
+
+    struct Voice
+    {
+        const std::int16_t* samples = nullptr;
+        std::size_t frameCount = 0;
+        std::size_t position = 0;   // frames already played
+        std::size_t delay = 0;      // frames until the voice starts
+        std::int32_t gain = 0;      // Q15 volume
+        bool active = false;
+    };
+
+    // Clip kept in the source format plus a copy converted to the stream format
+    struct Clip
+    {
+        sf::SoundBuffer source;
+        bool loaded = false;
+        std::vector<std::int16_t> converted;
+        std::size_t frameCount = 0;
+    };
+
+    void convertClip(Clip& clip);
+    void startVoice(const Event& e, double beatPosition, double framesPerBeat);
+
+    std::array<Clip, static_cast<std::size_t>(Sfx::Count)> m_clips;
+    std::array<Voice, MAX_VOICES> m_voices;
+    int m_activeVoices = 0;
+
+    // single producer (game) / single consumer (audio) ring buffer
+    std::array<Event, QUEUE_SIZE> m_queue;
+    std::atomic<unsigned int> m_queueHead{ 0 };
+    std::atomic<unsigned int> m_queueTail{ 0 };
+
+    unsigned int m_sampleRate = 0;
+    unsigned int m_channelCount = 0;
+};
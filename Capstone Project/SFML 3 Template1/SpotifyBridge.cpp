@@ -0,0 +1,1054 @@
+#include "SpotifyBridge.h"
+#include "HttpConnection.h"
+#include "NetSocket.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winhttp.h>
+#pragma comment(lib, "winhttp.lib")
+#endif
+
+namespace
+{
+    const char* BPM_CACHE_PATH = "../../Spotify test/bpm_cache.json"; // shared with the Node bridge
+    const char* REDIRECT_URI = "http://127.0.0.1:8888/callback";
+    const int POLL_INTERVAL_MS = 1000;
+    const int REPLAY_STEP_MS = 100;
+    const int EVENT_PING_MS = 5000;
+    const int ACCEPT_RETRY_MS = 100;
+
+    long long epochMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string getEnv(const char* name)
+    {
+#ifdef _MSC_VER
+        char* value = nullptr;
+        size_t length = 0;
+        std::string result;
+        if (_dupenv_s(&value, &length, name) == 0 && value)
+        {
+            result = value;
+            free(value);
+        }
+        return result;
+#else
+        const char* value = std::getenv(name);
+        return value ? value : "";
+#endif
+    }
+
+    std::string urlEncode(const std::string& text)
+    {
+        static const char* hex = "0123456789ABCDEF";
+        std::string out;
+        for (unsigned char c : text)
+        {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')
+            {
+                out += static_cast<char>(c);
+            }
+            else
+            {
+                out += '%';
+                out += hex[c >> 4];
+                out += hex[c & 15];
+            }
+        }
+        return out;
+    }
+
+    std::string base64(const std::string& text)
+    {
+        static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        size_t i = 0;
+        for (; i + 2 < text.size(); i += 3)
+        {
+            unsigned int n = (static_cast<unsigned char>(text[i]) << 16)
+                | (static_cast<unsigned char>(text[i + 1]) << 8)
+                | static_cast<unsigned char>(text[i + 2]);
+            out += table[(n >> 18) & 63];
+            out += table[(n >> 12) & 63];
+            out += table[(n >> 6) & 63];
+            out += table[n & 63];
+        }
+        if (i < text.size())
+        {
+            unsigned int n = static_cast<unsigned char>(text[i]) << 16;
+            if (i + 1 < text.size())
+                n |= static_cast<unsigned char>(text[i + 1]) << 8;
+            out += table[(n >> 18) & 63];
+            out += table[(n >> 12) & 63];
+            out += (i + 1 < text.size()) ? table[(n >> 6) & 63] : '=';
+            out += '=';
+        }
+        return out;
+    }
+
+    std::string queryValue(const std::string& query, const std::string& name)
+    {
+        size_t pos = 0;
+        while (pos < query.size())
+        {
+            size_t end = query.find('&', pos);
+            if (end == std::string::npos)
+                end = query.size();
+            if (query.compare(pos, name.size() + 1, name + "=") == 0)
+                return query.substr(pos + name.size() + 1, end - pos - name.size() - 1);
+            pos = end + 1;
+        }
+        return "";
+    }
+
+    // Blocking HTTPS request. Only Windows has a TLS stack we can rely on without
+    // extra dependencies, elsewhere Live mode is reported as unsupported
+    bool httpsRequest(const char* method, const std::string& host, const std::string& path,
+        const std::string& headers, const std::string& body, int& status, std::string& response)
+    {
+        response.clear();
+        status = 0;
+#ifdef _WIN32
+        std::wstring wideMethod(method, method + std::char_traits<char>::length(method));
+        std::wstring wideHost(host.begin(), host.end());
+        std::wstring widePath(path.begin(), path.end());
+        std::wstring wideHeaders(headers.begin(), headers.end());
+
+        HINTERNET session = WinHttpOpen(L"RhythmRealms/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+        if (!session)
+            return false;
+
+        HINTERNET connection = WinHttpConnect(session, wideHost.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0);
+        HINTERNET request = connection
+            ? WinHttpOpenRequest(connection, wideMethod.c_str(), widePath.c_str(), nullptr,
+                WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE)
+            : nullptr;
+
+        bool ok = request
+            && WinHttpSendRequest(request,
+                wideHeaders.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : wideHeaders.c_str(),
+                wideHeaders.empty() ? 0 : static_cast<DWORD>(-1),
+                body.empty() ? WINHTTP_NO_REQUEST_DATA : const_cast<char*>(body.data()),
+                static_cast<DWORD>(body.size()), static_cast<DWORD>(body.size()), 0)
+            && WinHttpReceiveResponse(request, nullptr);
+
+        if (ok)
+        {
+            DWORD code = 0;
+            DWORD size = sizeof(code);
+            WinHttpQueryHeaders(request, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                WINHTTP_HEADER_NAME_BY_INDEX, &code, &size, WINHTTP_NO_HEADER_INDEX);
+            status = static_cast<int>(code);
+
+            DWORD available = 0;
+            while (WinHttpQueryDataAvailable(request, &available) && available > 0)
+            {
+                size_t offset = response.size();
+                response.resize(offset + available);
+                DWORD read = 0;
+                if (!WinHttpReadData(request, &response[offset], available, &read))
+                {
+                    ok = false;
+                    break;
+                }
+                response.resize(offset + read);
+            }
+        }
+
+        if (request) WinHttpCloseHandle(request);
+        if (connection) WinHttpCloseHandle(connection);
+        WinHttpCloseHandle(session);
+        return ok;
+#else
+        (void)method; (void)host; (void)path; (void)headers; (void)body;
+        return false;
+#endif
+    }
+}
+
+SpotifyBridge::~SpotifyBridge()
+{
+    Stop();
+}
+
+bool SpotifyBridge::LiveSupported()
+{
+#ifdef _WIN32
+    return !getEnv("SPOTIFY_CLIENT_ID").empty()
+        && !getEnv("SPOTIFY_CLIENT_SECRET").empty()
+        && !getEnv("RAPIDAPI_KEY").empty();
+#else
+    return false;
+#endif
+}
+
+std::string SpotifyBridge::ReplayTimelineFromEnvironment()
+{
+    return getEnv("RHYTHM_SPOTIFY_REPLAY");
+}
+
+bool SpotifyBridge::Start(Mode mode, ReadyCallback onReady, const std::string& timelinePath)
+{
+    if (m_isRunning)
+        return true;
+
+    m_mode = mode;
+
+    if (mode == Mode::Live)
+    {
+        if (!LiveSupported())
+        {
+            std::cerr << "Spotify bridge: live mode needs SPOTIFY_CLIENT_ID, SPOTIFY_CLIENT_SECRET and RAPIDAPI_KEY" << std::endl;
+            return false;
+        }
+        m_clientId = getEnv("SPOTIFY_CLIENT_ID");
+        m_clientSecret = getEnv("SPOTIFY_CLIENT_SECRET");
+        m_rapidApiKey = getEnv("RAPIDAPI_KEY");
+        LoadBpmCache();
+    }
+    else if (!LoadTimeline(timelinePath))
+    {
+        return false;
+    }
+
+    HttpConnection::initNetwork();
+    m_isRunning = true;
+    m_acceptThread = std::thread(&SpotifyBridge::AcceptLoop, this, std::move(onReady));
+    m_sourceThread = std::thread(mode == Mode::Live ? &SpotifyBridge::LiveLoop : &SpotifyBridge::ReplayLoop, this);
+    return true;
+}
+
+void SpotifyBridge::Stop()
+{
+    // Threads may still be around after a failed start, so go by them rather than m_isRunning
+    if (!m_acceptThread.joinable() && !m_sourceThread.joinable())
+        return;
+
+    m_isRunning = false;
+
+    // Wake everything that might be blocked: accept, recv on clients, state waits
+    std::intptr_t listenSocket = m_listenSocket.exchange(-1);
+    if (listenSocket != -1)
+    {
+        shutdownSocket(static_cast<SocketHandle>(listenSocket));
+        closeSocket(static_cast<SocketHandle>(listenSocket));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_stateChanged.notify_all();
+    }
+
+    if (m_acceptThread.joinable())
+        m_acceptThread.join();
+    if (m_sourceThread.joinable())
+        m_sourceThread.join();
+
+    // Only sockets still registered are open; join outside the lock, as
+    // connection threads take it to close their socket
+    std::vector<std::unique_ptr<Connection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionMutex);
+        for (auto& connection : m_connections)
+        {
+            if (connection->socket != -1)
+                shutdownSocket(static_cast<SocketHandle>(connection->socket));
+        }
+        connections = std::move(m_connections);
+        m_connections.clear();
+    }
+    for (auto& connection : connections)
+    {
+        if (connection->thread.joinable())
+            connection->thread.join();
+    }
+
+    HttpConnection::shutdownNetwork();
+    std::cout << "Spotify bridge stopped" << std::endl;
+}
+
+bool SpotifyBridge::WaitForStop(int ms)
+{
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    return m_stateChanged.wait_for(lock, std::chrono::milliseconds(ms), [this] { return !m_isRunning; });
+}
+
+// ---------------------------------------------------------------------------
+// HTTP server
+
+void SpotifyBridge::AcceptLoop(ReadyCallback onReady)
+{
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == BAD_SOCKET)
+    {
+        m_isRunning = false;
+        if (onReady) onReady(false, "could not create socket");
+        return;
+    }
+
+#ifndef _WIN32
+    // Restarting the game shouldn't wait out TIME_WAIT. Not on Windows, where it
+    // would let us steal the port from a Node bridge that is already running
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+#endif
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 8) != 0)
+    {
+        closeSocket(listener);
+        m_isRunning = false;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_stateChanged.notify_all();
+        }
+        if (onReady) onReady(false, "port 8888 is already in use");
+        return;
+    }
+
+    m_listenSocket = static_cast<std::intptr_t>(listener);
+
+    // Stop() may have run between bind and the store above and found nothing to close
+    if (!m_isRunning)
+    {
+        if (m_listenSocket.exchange(-1) != -1)
+            closeSocket(listener);
+        if (onReady) onReady(false, "stopped");
+        return;
+    }
+
+    std::cout << "Spotify bridge running at http://127.0.0.1:" << PORT << "/ ("
+        << (m_mode == Mode::Live ? "live" : "replay") << ")" << std::endl;
+    if (onReady) onReady(true, m_mode == Mode::Live ? "listening (live)" : "listening (replay)");
+
+#ifdef _WIN32
+    if (m_mode == Mode::Live)
+    {
+        std::string authUrl = "https://accounts.spotify.com/authorize?response_type=code&client_id=" + urlEncode(m_clientId)
+            + "&scope=" + urlEncode("user-read-playback-state user-read-currently-playing")
+            + "&redirect_uri=" + urlEncode(REDIRECT_URI);
+        std::string command = "start \"\" \"" + authUrl + "\"";
+        system(command.c_str());
+    }
+#endif
+
+    while (m_isRunning)
+    {
+        SocketHandle client = accept(listener, nullptr, nullptr);
+        if (client == BAD_SOCKET)
+        {
+            // Stop() closes the listener to break us out. Anything else (out of
+            // descriptors, say) would fail again straight away, so don't spin on it
+            if (m_isRunning)
+                WaitForStop(ACCEPT_RETRY_MS);
+            continue;
+        }
+
+        int noDelay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        std::lock_guard<std::mutex> lock(m_connectionMutex);
+
+        // Tidy up clients that have gone away
+        for (auto it = m_connections.begin(); it != m_connections.end();)
+        {
+            if ((*it)->done)
+            {
+                (*it)->thread.join();
+                it = m_connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->socket = static_cast<std::intptr_t>(client);
+        connection->thread = std::thread(&SpotifyBridge::ServeConnection, this, connection.get());
+        m_connections.push_back(std::move(connection));
+    }
+}
+
+bool SpotifyBridge::SendResponse(std::intptr_t sock, int status, const char* contentType, const std::string& body)
+{
+    const char* reason = status == 200 ? "OK" : (status == 400 ? "Bad Request" : "Not Found");
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+        + "Content-Type: " + contentType + "\r\n"
+        + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        + "Connection: keep-alive\r\n\r\n"
+        + body;
+    return sendAll(static_cast<SocketHandle>(sock), response.data(), response.size());
+}
+
+void SpotifyBridge::CloseConnection(Connection* connection)
+{
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    closeSocket(static_cast<SocketHandle>(connection->socket));
+    connection->socket = -1;
+    connection->done = true;
+}
+
+void SpotifyBridge::ServeConnection(Connection* connection)
+{
+    std::intptr_t sock;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionMutex);
+        sock = connection->socket;
+    }
+    SocketHandle handle = static_cast<SocketHandle>(sock);
+    std::string buffer;
+    char chunk[2048];
+
+    while (m_isRunning)
+    {
+        // Requests are GETs, so everything up to the blank line is the whole request
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+        {
+            int received = recv(handle, chunk, sizeof(chunk), 0);
+            if (received <= 0 || buffer.size() > 16384)
+            {
+                CloseConnection(connection);
+                return;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
+        }
+
+        std::string request = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+
+        // GET /path?query HTTP/1.1
+        size_t methodEnd = request.find(' ');
+        size_t targetEnd = request.find(' ', methodEnd + 1);
+        std::string target = (methodEnd != std::string::npos && targetEnd != std::string::npos)
+            ? request.substr(methodEnd + 1, targetEnd - methodEnd - 1) : "/";
+        size_t queryStart = target.find('?');
+        std::string path = target.substr(0, queryStart);
+        std::string query = queryStart != std::string::npos ? target.substr(queryStart + 1) : "";
+
+        bool ok = true;
+        if (path == "/current")
+        {
+            std::string body;
+            {
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                body = m_stateJson.empty() ? "{\"bpm\":120}" : m_stateJson;
+            }
+            ok = SendResponse(sock, 200, "application/json", body);
+        }
+        else if (path == "/queue")
+        {
+            std::string n = queryValue(query, "n");
+            int limit = n.empty() ? 3 : std::clamp(std::atoi(n.c_str()), 1, 20);
+            ok = SendResponse(sock, 200, "application/json", QueueJson(limit));
+        }
+        else if (path == "/bpm")
+        {
+            ok = SendResponse(sock, 200, "application/json", BpmJson(queryValue(query, "id")));
+        }
+        else if (path == "/events")
+        {
+            ServeEvents(sock);
+            break;
+        }
+        else if (path == "/callback")
+        {
+            std::string code = queryValue(query, "code");
+            if (m_mode == Mode::Live && !code.empty())
+            {
+                ok = SendResponse(sock, 200, "text/plain", "Authorization successful!");
+                HandleCallback(code);
+            }
+            else
+            {
+                ok = SendResponse(sock, 400, "text/plain", "No authorization code");
+            }
+        }
+        else
+        {
+            ok = SendResponse(sock, 404, "text/plain", "Not Found");
+        }
+
+        if (!ok)
+            break;
+    }
+
+    CloseConnection(connection);
+}
+
+// Server-Sent Events: current state straight away, then every change, pings in between
+void SpotifyBridge::ServeEvents(std::intptr_t sock)
+{
+    SocketHandle handle = static_cast<SocketHandle>(sock);
+    const std::string header = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\nConnection: keep-alive\r\n\r\n";
+    if (!sendAll(handle, header.data(), header.size()))
+        return;
+
+    std::cout << "Spotify bridge: event subscriber connected" << std::endl;
+
+    unsigned int sentVersion = 0;
+    std::string message;
+
+    while (m_isRunning)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            bool changed = m_stateChanged.wait_for(lock, std::chrono::milliseconds(EVENT_PING_MS),
+                [&] { return !m_isRunning || m_stateVersion != sentVersion; });
+            if (!m_isRunning)
+                break;
+
+            if (changed)
+            {
+                message = "data: " + m_stateJson + "\n\n";
+                sentVersion = m_stateVersion;
+            }
+            else
+            {
+                message = ": ping\n\n";
+            }
+        }
+
+        if (!sendAll(handle, message.data(), message.size()))
+            break;
+    }
+
+    std::cout << "Spotify bridge: event subscriber left" << std::endl;
+}
+
+// ---------------------------------------------------------------------------
+// Shared state
+
+void SpotifyBridge::PublishState(const State& state)
+{
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+
+    std::string bpmText = std::to_string(state.bpm);
+    std::string key = state.track + "|" + state.artist + "|" + bpmText + "|" + state.bpmId + "|"
+        + (state.playing ? "1" : "0") + "|" + state.error;
+
+    // Same rule as the Node bridge: progress is extrapolated by the game,
+    // so only push it on its own when playback jumped (a seek)
+    bool seeked = false;
+    if (key == m_stateKey)
+    {
+        if (!state.playing || state.progressMs < 0 || m_state.progressMs < 0)
+            return;
+
+        long long expected = m_state.progressMs + (m_state.playing ? state.sampledAt - m_state.sampledAt : 0);
+        seeked = std::llabs(state.progressMs - expected) > 1500;
+        if (!seeked)
+            return;
+    }
+
+    m_state = state;
+    m_stateKey = key;
+
+    nlohmann::json j;
+    if (!state.error.empty())
+    {
+        j["error"] = state.error;
+    }
+    else
+    {
+        if (!state.id.empty()) j["id"] = state.id;
+        j["track"] = state.track;
+        j["artist"] = state.artist;
+        j["playing"] = state.playing;
+        if (state.progressMs >= 0) j["progress_ms"] = state.progressMs;
+        if (state.durationMs >= 0) j["duration_ms"] = state.durationMs;
+        if (state.sampledAt > 0) j["sampled_at"] = state.sampledAt;
+    }
+    j["bpm"] = state.bpm;
+    if (!state.bpmId.empty()) j["bpm_id"] = state.bpmId;
+    if (state.firstBeatMs >= 0.0) j["first_beat_ms"] = state.firstBeatMs;
+    j["changed_at"] = epochMs();
+
+    m_stateJson = j.dump();
+    ++m_stateVersion;
+    m_stateChanged.notify_all();
+}
+
+// Upcoming tracks for the game to warm its BPM cache with: { "queue": [ { id, track, artist, bpm? } ] }
+std::string SpotifyBridge::QueueJson(int limit)
+{
+    nlohmann::json queue = nlohmann::json::array();
+
+    if (m_mode == Mode::Replay)
+    {
+        size_t index = m_replayIndex;
+        for (int i = 1; i <= limit; ++i)
+        {
+            size_t next = index + i;
+            if (next >= m_timeline.size())
+            {
+                if (!m_loopTimeline)
+                    break;
+                next %= m_timeline.size();
+            }
+
+            const ReplayTrack& track = m_timeline[next];
+            queue.push_back({ { "id", track.id }, { "track", track.track }, { "artist", track.artist }, { "bpm", track.bpm } });
+        }
+    }
+    else
+    {
+        std::string token;
+        {
+            std::lock_guard<std::mutex> lock(m_tokenMutex);
+            token = m_accessToken;
+        }
+
+        int status = 0;
+        std::string response;
+        if (token.empty() || !httpsRequest("GET", "api.spotify.com", "/v1/me/player/queue",
+            "Authorization: Bearer " + token, "", status, response) || status != 200)
+        {
+            return "{\"error\":\"Queue unavailable\",\"queue\":[]}";
+        }
+
+        nlohmann::json data = nlohmann::json::parse(response, nullptr, false);
+        if (!data.is_discarded() && data.contains("queue") && data["queue"].is_array())
+        {
+            for (const auto& item : data["queue"])
+            {
+                if (static_cast<int>(queue.size()) >= limit)
+                    break;
+                if (!item.is_object() || !item.contains("id") || !item["id"].is_string())
+                    continue;
+
+                nlohmann::json entry = { { "id", item["id"] }, { "track", item.value("name", std::string()) } };
+                if (item.contains("artists") && item["artists"].is_array() && !item["artists"].empty())
+                    entry["artist"] = item["artists"][0].value("name", std::string());
+
+                double bpm;
+                if (CachedBpm(item["id"].get<std::string>(), bpm))
+                    entry["bpm"] = bpm;
+                queue.push_back(entry);
+            }
+        }
+    }
+
+    return nlohmann::json{ { "queue", queue } }.dump();
+}
+
+// BPM of any track, from the cache or a fresh lookup: { "id": ..., "bpm": ..., "first_beat_ms"?: ... }
+std::string SpotifyBridge::BpmJson(const std::string& trackId)
+{
+    nlohmann::json j = { { "id", trackId } };
+
+    double bpm = 0.0;
+    double firstBeatMs = -1.0;
+    bool found = false;
+    if (m_mode == Mode::Replay)
+    {
+        for (const ReplayTrack& track : m_timeline)
+        {
+            if (track.id == trackId)
+            {
+                bpm = track.bpm;
+                firstBeatMs = track.firstBeatMs;
+                found = true;
+                break;
+            }
+        }
+    }
+    else if (!trackId.empty())
+    {
+        found = CachedBpm(trackId, bpm) || LookupBpm(trackId, bpm);
+    }
+
+    if (found)
+    {
+        j["bpm"] = bpm;
+        if (firstBeatMs >= 0.0)
+            j["first_beat_ms"] = firstBeatMs;
+    }
+    else
+        j["error"] = "BPM unavailable";
+    return j.dump();
+}
+
+// ---------------------------------------------------------------------------
+// Replay mode
+
+// Timeline format:
+// { "loop": true, "time_scale": 1.0,
+//   "tracks": [ { "id": "...", "track": "...", "artist": "...", "bpm": 128,
+//                 "duration_ms": 30000, "bpm_delay_ms": 500, "first_beat_ms": 0 } ] }
+bool SpotifyBridge::LoadTimeline(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Spotify bridge: can't open replay timeline " << path << std::endl;
+        return false;
+    }
+
+    nlohmann::json data = nlohmann::json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.contains("tracks") || !data["tracks"].is_array())
+    {
+        std::cerr << "Spotify bridge: invalid replay timeline " << path << std::endl;
+        return false;
+    }
+
+    m_timeline.clear();
+    m_loopTimeline = data.value("loop", true);
+    m_timeScale = std::max(0.01, data.value("time_scale", 1.0));
+
+    for (const auto& entry : data["tracks"])
+    {
+        ReplayTrack track;
+        track.id = entry.value("id", "replay-" + std::to_string(m_timeline.size() + 1));
+        track.track = entry.value("track", std::string("Replay Track"));
+        track.artist = entry.value("artist", std::string("Replay"));
+        track.bpm = entry.value("bpm", 120.0);
+        track.durationMs = std::max(1000LL, entry.value("duration_ms", 30000LL));
+        track.bpmDelayMs = std::max(0LL, entry.value("bpm_delay_ms", 0LL));
+        track.firstBeatMs = entry.value("first_beat_ms", -1.0);
+        m_timeline.push_back(track);
+    }
+
+    if (m_timeline.empty())
+    {
+        std::cerr << "Spotify bridge: replay timeline has no tracks" << std::endl;
+        return false;
+    }
+
+    std::cout << "Spotify bridge: loaded " << m_timeline.size() << " replay tracks from " << path << std::endl;
+    return true;
+}
+
+void SpotifyBridge::ReplayLoop()
+{
+    size_t index = 0;
+    double previousBpm = m_timeline.front().bpm;
+    std::string previousId;
+    auto trackStart = std::chrono::steady_clock::now();
+    bool finished = false;
+
+    while (m_isRunning)
+    {
+        if (finished)
+        {
+            WaitForStop(POLL_INTERVAL_MS);
+            continue;
+        }
+
+        const ReplayTrack& track = m_timeline[index];
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - trackStart).count() * m_timeScale;
+
+        if (elapsed >= track.durationMs)
+        {
+            previousBpm = track.bpm;
+            previousId = track.id;
+            trackStart = std::chrono::steady_clock::now();
+
+            if (++index == m_timeline.size())
+            {
+                index = 0;
+                if (!m_loopTimeline)
+                {
+                    State stopped = m_state;
+                    stopped.playing = false;
+                    stopped.sampledAt = epochMs();
+                    PublishState(stopped);
+                    finished = true;
+                }
+            }
+            m_replayIndex = index;
+            continue;
+        }
+
+        State state;
+        state.id = track.id;
+        state.track = track.track;
+        state.artist = track.artist;
+        bool bpmKnown = elapsed >= track.bpmDelayMs;
+        state.bpm = bpmKnown ? track.bpm : previousBpm;
+        state.bpmId = bpmKnown ? track.id : previousId;
+        state.firstBeatMs = bpmKnown ? track.firstBeatMs : -1.0;
+        state.playing = true;
+        state.progressMs = static_cast<long long>(elapsed);
+        state.durationMs = track.durationMs;
+        state.sampledAt = epochMs();
+        PublishState(state);
+
+        WaitForStop(REPLAY_STEP_MS);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Live mode
+
+void SpotifyBridge::LiveLoop()
+{
+    while (m_isRunning)
+    {
+        bool haveToken;
+        {
+            std::lock_guard<std::mutex> lock(m_tokenMutex);
+            haveToken = !m_accessToken.empty();
+        }
+
+        if (haveToken)
+        {
+            PollSpotify();
+        }
+        else
+        {
+            State state;
+            state.error = "No access token yet.";
+            state.bpm = m_currentBpm;
+            PublishState(state);
+        }
+
+        WaitForStop(POLL_INTERVAL_MS);
+    }
+}
+
+void SpotifyBridge::HandleCallback(const std::string& code)
+{
+    if (ExchangeCode(code))
+        std::cout << "Spotify bridge: tokens received" << std::endl;
+}
+
+bool SpotifyBridge::ExchangeCode(const std::string& code)
+{
+    std::string body = "grant_type=authorization_code&code=" + urlEncode(code)
+        + "&redirect_uri=" + urlEncode(REDIRECT_URI);
+    std::string headers = "Content-Type: application/x-www-form-urlencoded\r\nAuthorization: Basic "
+        + base64(m_clientId + ":" + m_clientSecret);
+
+    int status = 0;
+    std::string response;
+    if (!httpsRequest("POST", "accounts.spotify.com", "/api/token", headers, body, status, response))
+    {
+        std::cerr << "Spotify bridge: token request failed" << std::endl;
+        return false;
+    }
+
+    nlohmann::json data = nlohmann::json::parse(response, nullptr, false);
+    if (data.is_discarded() || !data.contains("access_token"))
+    {
+        std::cerr << "Spotify bridge: error fetching tokens (" << status << ")" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_tokenMutex);
+    m_accessToken = data.value("access_token", std::string());
+    m_refreshToken = data.value("refresh_token", m_refreshToken);
+    return true;
+}
+
+bool SpotifyBridge::RefreshToken()
+{
+    std::string refreshToken;
+    {
+        std::lock_guard<std::mutex> lock(m_tokenMutex);
+        refreshToken = m_refreshToken;
+    }
+    if (refreshToken.empty())
+        return false;
+
+    std::string body = "grant_type=refresh_token&refresh_token=" + urlEncode(refreshToken);
+    std::string headers = "Content-Type: application/x-www-form-urlencoded\r\nAuthorization: Basic "
+        + base64(m_clientId + ":" + m_clientSecret);
+
+    int status = 0;
+    std::string response;
+    if (!httpsRequest("POST", "accounts.spotify.com", "/api/token", headers, body, status, response))
+        return false;
+
+    nlohmann::json data = nlohmann::json::parse(response, nullptr, false);
+    if (data.is_discarded() || !data.contains("access_token"))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_tokenMutex);
+    m_accessToken = data.value("access_token", std::string());
+    m_refreshToken = data.value("refresh_token", m_refreshToken);
+    std::cout << "Spotify bridge: access token refreshed" << std::endl;
+    return true;
+}
+
+void SpotifyBridge::PollSpotify()
+{
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(m_tokenMutex);
+        token = m_accessToken;
+    }
+
+    int status = 0;
+    std::string response;
+    State state;
+    state.bpm = m_currentBpm;
+
+    if (!httpsRequest("GET", "api.spotify.com", "/v1/me/player/currently-playing",
+        "Authorization: Bearer " + token, "", status, response))
+    {
+        state.error = "Spotify request failed";
+        PublishState(state);
+        return;
+    }
+
+    if (status == 401)
+    {
+        RefreshToken();
+        return;
+    }
+
+    if (status == 204 || response.empty())
+    {
+        state.playing = false;
+        PublishState(state);
+        return;
+    }
+
+    nlohmann::json data = nlohmann::json::parse(response, nullptr, false);
+    if (data.is_discarded() || !data.is_object())
+    {
+        state.error = "Bad response from Spotify";
+        PublishState(state);
+        return;
+    }
+
+    const nlohmann::json& item = data.contains("item") && data["item"].is_object() ? data["item"] : nlohmann::json::object();
+    state.id = item.value("id", std::string());
+    state.track = item.value("name", std::string());
+    if (item.contains("artists") && item["artists"].is_array() && !item["artists"].empty())
+        state.artist = item["artists"][0].value("name", std::string());
+    state.playing = data.value("is_playing", false);
+    state.progressMs = data.value("progress_ms", -1LL);
+    state.durationMs = item.value("duration_ms", -1LL);
+    state.sampledAt = epochMs();
+
+    bool needsLookup = false;
+    if (!state.id.empty() && state.id != m_lastTrackId)
+    {
+        m_lastTrackId = state.id;
+        std::cout << "Spotify bridge: track changed: " << state.track << " by " << state.artist << std::endl;
+
+        double bpm;
+        if (CachedBpm(state.id, bpm))
+        {
+            m_currentBpm = bpm;
+            m_currentBpmTrackId = state.id;
+            state.bpm = m_currentBpm;
+        }
+        else
+        {
+            needsLookup = true;
+        }
+    }
+    state.bpmId = m_currentBpmTrackId;
+
+    PublishState(state);
+
+    // Push the track change first, the BPM follows once the lookup lands
+    if (needsLookup)
+    {
+        double bpm;
+        if (LookupBpm(state.id, bpm))
+        {
+            m_currentBpm = bpm;
+            m_currentBpmTrackId = state.id;
+            state.bpm = m_currentBpm;
+            state.bpmId = m_currentBpmTrackId;
+            PublishState(state);
+            std::cout << "Spotify bridge: BPM updated: " << m_currentBpm << " (cached)" << std::endl;
+        }
+    }
+}
+
+bool SpotifyBridge::CachedBpm(const std::string& trackId, double& bpm)
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto cached = m_bpmCache.find(trackId);
+    if (cached == m_bpmCache.end())
+        return false;
+    bpm = cached->second;
+    return true;
+}
+
+// Fetches and caches the BPM of any track, applying it is up to the caller
+bool SpotifyBridge::LookupBpm(const std::string& trackId, double& bpm)
+{
+    std::string headers = "x-rapidapi-key: " + m_rapidApiKey + "\r\nx-rapidapi-host: track-analysis.p.rapidapi.com";
+
+    int status = 0;
+    std::string response;
+    if (!httpsRequest("GET", "track-analysis.p.rapidapi.com", "/pktx/spotify/" + trackId, headers, "", status, response))
+    {
+        std::cerr << "Spotify bridge: BPM lookup failed" << std::endl;
+        return false;
+    }
+
+    if (status == 429)
+    {
+        std::cout << "Spotify bridge: rate limit hit, no BPM for " << trackId << std::endl;
+        return false;
+    }
+
+    nlohmann::json data = nlohmann::json::parse(response, nullptr, false);
+    if (data.is_discarded() || !data.contains("tempo") || !data["tempo"].is_number())
+    {
+        std::cout << "Spotify bridge: no tempo in BPM response" << std::endl;
+        return false;
+    }
+
+    bpm = data["tempo"].get<double>();
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_bpmCache[trackId] = bpm;
+        SaveBpmCache();
+    }
+    return true;
+}
+
+void SpotifyBridge::LoadBpmCache()
+{
+    std::ifstream file(BPM_CACHE_PATH);
+    if (!file.is_open())
+        return;
+
+    nlohmann::json data = nlohmann::json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    for (auto it = data.begin(); it != data.end(); ++it)
+    {
+        if (it.value().is_number())
+            m_bpmCache[it.key()] = it.value().get<double>();
+    }
+    std::cout << "Spotify bridge: loaded " << m_bpmCache.size() << " cached BPMs" << std::endl;
+}
+
+// Caller holds m_cacheMutex
+void SpotifyBridge::SaveBpmCache()
+{
+    nlohmann::json data = nlohmann::json::object();
+    for (const auto& entry : m_bpmCache)
+        data[entry.first] = entry.second;
+
+    std::ofstream file(BPM_CACHE_PATH);
+    if (file.is_open())
+        file << data.dump(2);
+}
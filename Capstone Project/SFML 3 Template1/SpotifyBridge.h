@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// In-process replacement for "Spotify test/server.js". Serves the same
+// /callback, /current, /events, /queue and /bpm endpoints on 127.0.0.1:8888 so SpotifyClient
+// talks to it exactly like the Node bridge.
+//  Live   - Spotify Web API + RapidAPI BPM lookup (Windows, WinHTTP). Credentials
+//           come from SPOTIFY_CLIENT_ID, SPOTIFY_CLIENT_SECRET and RAPIDAPI_KEY
+//  Replay - plays back a canned track timeline, no network needed
+class SpotifyBridge
+{
+public:
+    enum class Mode
+    {
+        Live,
+        Replay
+    };
+
+    // Called once from the bridge thread when it is listening (ok) or gave up
+    using ReadyCallback = std::function<void(bool ok, const std::string& message)>;
+
+    static constexpr unsigned short PORT = 8888;
+
+    SpotifyBridge() = default;
+    ~SpotifyBridge();
+
+    SpotifyBridge(const SpotifyBridge&) = delete;
+    SpotifyBridge& operator=(const SpotifyBridge&) = delete;
+
+    // Returns straight away, false if the mode can't run here (no credentials, bad timeline)
+    bool Start(Mode mode, ReadyCallback onReady, const std::string& timelinePath = "");
+    void Stop();
+    bool IsRunning() const { return m_isRunning; }
+
+    // Live mode needs WinHTTP and credentials in the environment
+    static bool LiveSupported();
+    // Timeline named by RHYTHM_SPOTIFY_REPLAY, empty when not set
+    static std::string ReplayTimelineFromEnvironment();
+
+private:
+    struct State
+    {
+        std::string id;
+        std::string track;
+        std::string artist;
+        std::string error;
+        std::string bpmId;          // track the bpm belongs to, lags id while a lookup is pending
+        double bpm = 120.0;
+        double firstBeatMs = -1.0;  // where bpmId's first beat falls, -1 if the source doesn't say
+        bool playing = false;
+        long long progressMs = -1;
+        long long durationMs = -1;
+        long long sampledAt = 0;
+    };
+
+    struct ReplayTrack
+    {
+        std::string id;
+        std::string track;
+        std::string artist;
+        double bpm = 120.0;
+        long long durationMs = 30000;
+        long long bpmDelayMs = 0;   // simulates the BPM lookup lagging the track change
+        double firstBeatMs = -1.0;
+    };
+
+    // HTTP server
+    struct Connection;
+    void AcceptLoop(ReadyCallback onReady);
+    void ServeConnection(Connection* connection);
+    void CloseConnection(Connection* connection);
+    void ServeEvents(std::intptr_t sock);
+    bool SendResponse(std::intptr_t sock, int status, const char* contentType, const std::string& body);
+    std::string QueueJson(int limit);
+    std::string BpmJson(const std::string& trackId);
+
+    // State sources
+    void LiveLoop();
+    void ReplayLoop();
+    bool LoadTimeline(const std::string& path);
+    void PublishState(const State& state);
+    bool WaitForStop(int ms);
+
+    // Live mode helpers
+    void HandleCallback(const std::string& query);
+    bool ExchangeCode(const std::string& code);
+    bool RefreshToken();
+    void PollSpotify();
+    bool LookupBpm(const std::string& trackId, double& bpm);
+    bool CachedBpm(const std::string& trackId, double& bpm);
+    void LoadBpmCache();
+    void SaveBpmCache();
+
+    Mode m_mode = Mode::Replay;
+    std::atomic<bool> m_isRunning{ false };
+    std::thread m_acceptThread;
+    std::thread m_sourceThread;
+    std::atomic<std::intptr_t> m_listenSocket{ -1 };
+
+    // One thread per client connection, finished ones are joined on the next accept.
+    // socket goes back to -1 (under m_connectionMutex) once the thread has closed it
+    struct Connection
+    {
+        std::thread thread;
+        std::intptr_t socket = -1;
+        std::atomic<bool> done{ false };
+    };
+    std::mutex m_connectionMutex;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+
+    // Latest state, serialised once per change and shared by every request
+    std::mutex m_stateMutex;
+    std::condition_variable m_stateChanged;
+    State m_state;
+    std::string m_stateJson;
+    std::string m_stateKey;
+    unsigned int m_stateVersion = 0;
+
+    // Live mode
+    std::string m_clientId;
+    std::string m_clientSecret;
+    std::string m_rapidApiKey;
+    std::mutex m_tokenMutex;
+    std::string m_accessToken;
+    std::string m_refreshToken;
+    std::string m_lastTrackId;
+    double m_currentBpm = 120.0;
+    std::string m_currentBpmTrackId;
+    std::mutex m_cacheMutex;    // source thread and /bpm requests both fill the cache
+    std::unordered_map<std::string, double> m_bpmCache;
+
+    // Replay mode
+    std::vector<ReplayTrack> m_timeline;
+    bool m_loopTimeline = true;
+    double m_timeScale = 1.0;
+    std::atomic<std::size_t> m_replayIndex{ 0 };    // track playing now, for /queue
+};
@@ -1,22 +1,38 @@
 #include "SpotifyClient.h"
+#include "json.hpp"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <type_traits>
 
 SpotifyClient::SpotifyClient()
     : m_isRunning(false)
+    , m_prefetchConnection("127.0.0.1", 8888)
+    , m_connection("127.0.0.1", 8888)
+    , m_eventConnection("127.0.0.1", 8888)
 {
-#ifdef _WIN32
-    WSADATA wsaData;
-    WSAStartup(MAKEWORD(2, 2), &wsaData);
-#endif
+    HttpConnection::initNetwork();
+
+    // Bridge pings the stream every 5s, anything longer means it has gone
+    m_eventConnection.setReceiveTimeout(12000);
 }
 
 SpotifyClient::~SpotifyClient()
 {
     StopPolling();
-#ifdef _WIN32
-    WSACleanup();
-#endif
+    m_connection.disconnect();
+    m_eventConnection.disconnect();
+    m_prefetchConnection.disconnect();
+    HttpConnection::shutdownNetwork();
 }
 
 void SpotifyClient::StartPolling()
@@ -24,8 +40,15 @@ void SpotifyClient::StartPolling()
     if (m_isRunning)
         return;
 
+    LoadBpmCache();
+
+    m_connection.clearInterrupt();
+    m_eventConnection.clearInterrupt();
+    m_prefetchConnection.clearInterrupt();
+
     m_isRunning = true;
     m_pollingThread = std::thread(&SpotifyClient::PollingLoop, this);
+    m_prefetchThread = std::thread(&SpotifyClient::PrefetchLoop, this);
     std::cout << "Spotify polling started" << std::endl;
 }
 
@@ -34,134 +57,782 @@ void SpotifyClient::StopPolling()
     if (!m_isRunning)
         return;
 
-    m_isRunning = false;
+    auto stopStart = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_isRunning = false;
+    }
+    m_stopCondition.notify_all();
+    m_eventConnection.interrupt();
+    m_connection.interrupt();
+    m_prefetchConnection.interrupt();
     if (m_pollingThread.joinable())
         m_pollingThread.join();
+    if (m_prefetchThread.joinable())
+        m_prefetchThread.join();
+
+    // Stop is meant to be instant, anything slow means a blocking call missed the interrupt
+    double stopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count();
+    if (stopMs > 100.0)
+        std::cerr << "Spotify polling took " << stopMs << "ms to stop" << std::endl;
 
-    std::cout << "Spotify polling stopped" << std::endl;
+    SaveBpmCache();
+
+    Telemetry telemetry = GetTelemetry();
+    std::cout << "Spotify polling stopped - " << telemetry.requests << " requests, "
+        << telemetry.failures << " failures, " << telemetry.pushedEvents << " pushed events, "
+        << "average staleness " << telemetry.averageStalenessMs << "ms" << std::endl;
 }
 
-SpotifyClient::TrackInfo SpotifyClient::GetCurrentTrack()
+SpotifyClient::TrackInfo SpotifyClient::GetCurrentTrack() const
 {
-    std::lock_guard<std::mutex> lock(m_trackMutex);
-    return m_currentTrack;
+    TrackInfo copy;
+    for (;;)
+    {
+        unsigned int before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue; // writer active, it only takes a few hundred bytes to finish
+
+        std::memcpy(&copy, &m_sharedTrack, sizeof(TrackInfo));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (m_sequence.load(std::memory_order_relaxed) == before)
+            return copy;
+    }
+}
+
+HttpConnection::Stats SpotifyClient::GetConnectionStats() const
+{
+    return m_connection.getStats();
+}
+
+namespace
+{
+    long long steadyNowUs()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+double SpotifyClient::GetPlaybackPositionMs() const
+{
+    TrackInfo track = GetCurrentTrack();
+    if (track.sampleTimeUs == 0)
+        return 0.0;
+
+    double position = track.progressMs;
+    if (track.isPlaying)
+        position += (steadyNowUs() - track.sampleTimeUs) / 1000.0;
+
+    if (track.durationMs > 0)
+        position = std::min(position, static_cast<double>(track.durationMs));
+    return position;
+}
+
+float SpotifyClient::GetBeatPhase(float beatOffsetMs) const
+{
+    TrackInfo track = GetCurrentTrack();
+    if (track.sampleTimeUs == 0 || !track.isPlaying || track.bpm <= 0.f)
+        return -1.f;
+
+    double position = track.progressMs + (steadyNowUs() - track.sampleTimeUs) / 1000.0;
+    if (track.durationMs > 0)
+        position = std::min(position, static_cast<double>(track.durationMs));
+    double offset = track.firstBeatMs >= 0.f ? track.firstBeatMs : beatOffsetMs;
+    double beats = (position - offset) * track.bpm / 60000.0;
+    return static_cast<float>(beats - std::floor(beats));
 }
 
 
 void SpotifyClient::PollingLoop()
 {
+    // Polls made while the event stream is down before trying to subscribe again
+    const int STREAM_RETRY_POLLS = 5;
+    int pollCount = 0;
+
     while (m_isRunning)
     {
-        try
+        // Preferred path: the bridge pushes changes as soon as it sees them
+        if (m_eventConnection.openStream("/events"))
         {
-            std::string response = HttpGet("127.0.0.1:8888", "/current");
+            std::cout << "Spotify event stream connected" << std::endl;
+            ReadEvents();
+
+            if (!m_isRunning)
+                break;
+            std::cout << "Spotify event stream lost, falling back to polling" << std::endl;
+        }
+
+        // Older bridge without /events, or bridge not up yet
+        for (int i = 0; i < STREAM_RETRY_POLLS && m_isRunning; ++i)
+        {
+            bool ok = PollOnce(pollCount);
+            if (!WaitForNextPoll(NextPollDelayMs(ok)))
+                break;
+        }
+    }
+}
+
+// Relaxed mid-song, tight around the expected end of the track, exponential back-off on errors
+int SpotifyClient::NextPollDelayMs(bool lastPollOk)
+{
+    const int IDLE_MS = 2000;
+    const int RELAXED_MS = 5000;
+    const int NEAR_END_MS = 3000;
+    const int FAST_MS = 500;
+    const int BACKOFF_BASE_MS = 1000;
+    const int BACKOFF_MAX_MS = 30000;
+
+    if (!lastPollOk)
+    {
+        m_consecutiveFailures = std::min(m_consecutiveFailures + 1, 6);
+        return std::min(BACKOFF_MAX_MS, BACKOFF_BASE_MS << (m_consecutiveFailures - 1));
+    }
+    m_consecutiveFailures = 0;
+
+    if (!m_currentTrack.isPlaying || m_currentTrack.durationMs <= 0)
+        return IDLE_MS;
+
+    // Wake up just before the track should end, then poll fast until it changes
+    double remaining = m_currentTrack.durationMs - GetPlaybackPositionMs();
+    if (remaining <= NEAR_END_MS)
+        return FAST_MS;
+    return std::clamp(static_cast<int>(remaining) - NEAR_END_MS, FAST_MS, RELAXED_MS);
+}
+
+bool SpotifyClient::WaitForNextPoll(int ms)
+{
+    std::unique_lock<std::mutex> lock(m_stopMutex);
+    m_stopCondition.wait_for(lock, std::chrono::milliseconds(ms), [this] { return !m_isRunning; });
+    return m_isRunning;
+}
+
+// Age of the data grows linearly between confirmations, so each gap adds a
+// triangle to the staleness area. While the push stream is up nothing can go
+// stale without us hearing about it, so those gaps count as fresh
+void SpotifyClient::MarkFresh(bool pushed)
+{
+    long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> lock(m_telemetryMutex);
+    if (m_lastFreshUs > 0)
+    {
+        double gap = static_cast<double>(now - m_lastFreshUs);
+        m_observedUs += gap;
+        if (!pushed)
+            m_staleAreaUs += gap * gap * 0.5;
+    }
+    m_lastFreshUs = now;
+}
+
+SpotifyClient::Telemetry SpotifyClient::GetTelemetry() const
+{
+    HttpConnection::Stats polls = m_connection.getStats();
+    HttpConnection::Stats stream = m_eventConnection.getStats();
+
+    Telemetry telemetry;
+    telemetry.requests = polls.requests + stream.requests;
+    telemetry.failures = polls.failures + stream.failures;
+
+    std::lock_guard<std::mutex> lock(m_telemetryMutex);
+    telemetry.pushedEvents = m_pushedEvents;
+    telemetry.averageStalenessMs = m_observedUs > 0.0 ? m_staleAreaUs / m_observedUs / 1000.0 : 0.0;
+    return telemetry;
+}
+
+void SpotifyClient::ReadEvents()
+{
+    m_eventData.clear();
+
+    m_consecutiveFailures = 0;
+    MarkFresh(true);
+
+    while (m_isRunning && m_eventConnection.readStreamLine(m_eventLine))
+    {
+        // Any line, pings included, proves the stream is still live
+        MarkFresh(true);
+
+        if (m_eventLine.empty())
+        {
+            // Blank line ends an event
+            if (m_eventData.empty())
+                continue;
+
+            if (ParseTrackData(m_eventData) && m_lastChangedAt >= 0)
+            {
+                long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                m_lastUpdateLatencyMs = static_cast<float>(now - m_lastChangedAt);
+                std::cout << "Spotify update latency: " << (now - m_lastChangedAt) << "ms" << std::endl;
+            }
 
-            if (!response.empty())
             {
-                ParseTrackData(response);
+                std::lock_guard<std::mutex> lock(m_telemetryMutex);
+                ++m_pushedEvents;
             }
+            m_eventData.clear();
+        }
+        else if (m_eventLine.compare(0, 5, "data:") == 0)
+        {
+            size_t start = (m_eventLine.size() > 5 && m_eventLine[5] == ' ') ? 6 : 5;
+            m_eventData.append(m_eventLine, start, std::string::npos);
+        }
+        // lines starting with ':' are keep-alive pings
+    }
+}
+
+bool SpotifyClient::PollOnce(int& pollCount)
+{
+    bool ok = HttpGet("/current", m_response) && !m_response.empty();
+    if (ok)
+    {
+        ParseTrackData(m_response);
+        MarkFresh(false);
+    }
+
+    // Per-poll cost, every 30 polls
+    if (++pollCount % 30 == 0)
+    {
+        HttpConnection::Stats stats = m_connection.getStats();
+        Telemetry telemetry = GetTelemetry();
+        std::cout << "Spotify bridge: " << stats.requests << " requests, "
+            << stats.connects << " connects, " << stats.failures << " failures, "
+            << "avg " << stats.avgRequestMs << "ms, max " << stats.maxRequestMs << "ms, "
+            << "last connect " << stats.lastConnectMs << "ms, "
+            << "average staleness " << telemetry.averageStalenessMs << "ms" << std::endl;
+    }
+
+    return ok;
+}
+
+bool SpotifyClient::HttpGet(const std::string& path, std::string& body)
+{
+    if (!m_connection.get(path, body))
+        return false;
+
+    return m_connection.getLastStatus() == 200;
+}
+
+namespace
+{
+    // Number for a TrackInfo field. NaN, infinities and anything the field's type
+    // can't hold make the field malformed, instead of undefined behaviour in the cast
+    template <typename T>
+    bool toField(double val, T& out)
+    {
+        if (!std::isfinite(val))
+            return false;
+
+        if constexpr (std::is_integral_v<T>)
+        {
+            // lowest() is exactly -2^n, so -lowest() is the first value past max()
+            const double lowest = static_cast<double>(std::numeric_limits<T>::lowest());
+            if (val < lowest || val >= -lowest)
+                return false;
         }
-        catch (const std::exception& e)
+        else if (std::abs(val) > std::numeric_limits<T>::max())
         {
-            std::cerr << "Polling error: " << e.what() << std::endl;
+            return false;
         }
 
-        // Poll every 2 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        out = static_cast<T>(val);
+        return true;
     }
+
+    // SAX handler for the flat objects the bridge sends. Writes straight into the
+    // working TrackInfo, only top-level keys are looked at so nested objects
+    // (or a stray "name" inside one) can't overwrite the wrong field
+    class BridgeHandler : public nlohmann::json_sax<nlohmann::json>
+    {
+    public:
+        enum class Field { None, Id, Track, Name, Artist, Bpm, Progress, Duration, Playing, Error, ChangedAt, SampledAt, BpmId, FirstBeat };
+
+        BridgeHandler(SpotifyClient::TrackInfo& track)
+            : m_track(track)
+        {
+        }
+
+        SpotifyClient::TrackInfo& m_track;
+        bool hasError = false;
+        bool hasTrack = false;
+        long long changedAt = -1;
+        long long sampledAt = -1;
+        float firstBeatMs = -1.f;
+        bool hasProgress = false;
+        bool hasBpmId = false;
+        char bpmId[SpotifyClient::TrackInfo::ID_SIZE] = {};
+
+        bool key(string_t& val) override
+        {
+            m_field = Field::None;
+            if (m_depth != 1)
+                return true;
+
+            if (val == "id") m_field = Field::Id;
+            else if (val == "track") m_field = Field::Track;
+            else if (val == "name") m_field = Field::Name;
+            else if (val == "artist") m_field = Field::Artist;
+            else if (val == "bpm") m_field = Field::Bpm;
+            else if (val == "progress_ms") m_field = Field::Progress;
+            else if (val == "duration_ms") m_field = Field::Duration;
+            else if (val == "playing") m_field = Field::Playing;
+            else if (val == "error") m_field = Field::Error;
+            else if (val == "changed_at") m_field = Field::ChangedAt;
+            else if (val == "sampled_at") m_field = Field::SampledAt;
+            else if (val == "bpm_id") m_field = Field::BpmId;
+            else if (val == "first_beat_ms") m_field = Field::FirstBeat;
+            return true;
+        }
+
+        bool string(string_t& val) override
+        {
+            switch (m_field)
+            {
+            case Field::Id: copyText(m_track.trackId, SpotifyClient::TrackInfo::ID_SIZE, val); break;
+            case Field::Track:
+                copyText(m_track.trackName, SpotifyClient::TrackInfo::TEXT_SIZE, val);
+                hasTrack = true;
+                break;
+            case Field::Name:
+                // Older bridges sent "name", "track" wins if both are present
+                if (!hasTrack)
+                    copyText(m_track.trackName, SpotifyClient::TrackInfo::TEXT_SIZE, val);
+                break;
+            case Field::Artist: copyText(m_track.artistName, SpotifyClient::TrackInfo::TEXT_SIZE, val); break;
+            case Field::Error: hasError = true; break;
+            case Field::BpmId:
+                copyText(bpmId, SpotifyClient::TrackInfo::ID_SIZE, val);
+                hasBpmId = true;
+                break;
+            default: break;
+            }
+            m_field = Field::None;
+            return true;
+        }
+
+        bool number_integer(number_integer_t val) override { return number(static_cast<double>(val)); }
+        bool number_unsigned(number_unsigned_t val) override { return number(static_cast<double>(val)); }
+        bool number_float(number_float_t val, const string_t&) override { return number(val); }
+
+        bool boolean(bool val) override
+        {
+            if (m_field == Field::Playing)
+                m_track.isPlaying = val;
+            m_field = Field::None;
+            return true;
+        }
+
+        bool null() override
+        {
+            m_field = Field::None;
+            return true;
+        }
+
+        bool binary(binary_t&) override { return true; }
+        bool start_object(std::size_t) override { ++m_depth; m_field = Field::None; return true; }
+        bool end_object() override { --m_depth; return true; }
+        bool start_array(std::size_t) override { ++m_depth; m_field = Field::None; return true; }
+        bool end_array() override { --m_depth; return true; }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override
+        {
+            std::cerr << "Bridge JSON error at " << position << ": " << ex.what() << std::endl;
+            return false;
+        }
+
+    private:
+        static void copyText(char* dest, int size, const string_t& src)
+        {
+            size_t length = src.copy(dest, static_cast<size_t>(size - 1));
+            dest[length] = '\0';
+        }
+
+        // False (the whole payload is rejected) when a known field is out of range
+        bool number(double val)
+        {
+            bool ok = true;
+            switch (m_field)
+            {
+            case Field::Bpm: ok = toField(val, m_track.bpm); break;
+            case Field::Progress:
+                ok = toField(val, m_track.progressMs);
+                hasProgress = true;
+                break;
+            case Field::Duration: ok = toField(val, m_track.durationMs); break;
+            case Field::ChangedAt: ok = toField(val, changedAt); break;
+            case Field::SampledAt: ok = toField(val, sampledAt); break;
+            case Field::FirstBeat: ok = toField(val, firstBeatMs); break;
+            default: break;
+            }
+            m_field = Field::None;
+
+            if (!ok)
+                std::cerr << "Bridge JSON: number out of range (" << val << ")" << std::endl;
+            return ok;
+        }
+
+        int m_depth = 0;
+        Field m_field = Field::None;
+    };
 }
 
-std::string SpotifyClient::HttpGet(const std::string& host, const std::string& path)
+// One pass over the response, no intermediate DOM or substrings
+bool SpotifyClient::ParseTrackData(std::string_view jsonResponse)
 {
-#ifdef _WIN32
-    SOCKET sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock == INVALID_SOCKET)
-        return "";
+    // Parse into a scratch copy so a malformed payload leaves the last good state alone
+    TrackInfo parsed = m_currentTrack;
+    BridgeHandler handler(parsed);
 
-    // Parse host and port
-    std::string hostName = host.substr(0, host.find(':'));
-    std::string portStr = host.substr(host.find(':') + 1);
-    int port = std::stoi(portStr);
+    if (!nlohmann::json::sax_parse(jsonResponse.data(), jsonResponse.data() + jsonResponse.size(), &handler))
+        return false;
 
-    sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port);
-    inet_pton(AF_INET, hostName.c_str(), &serverAddr.sin_addr);
+    m_lastChangedAt = handler.changedAt;
 
-    if (connect(sock, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR)
+    if (handler.hasError)
     {
-        closesocket(sock);
-        return "";
+        m_currentTrack.isPlaying = false;
+        PublishTrack();
+        return true;
     }
 
-    // Send HTTP GET request
-    std::string request = "GET " + path + " HTTP/1.1\r\n";
-    request += "Host: " + hostName + "\r\n";
-    request += "Connection: close\r\n\r\n";
+    if (handler.hasProgress)
+    {
+        // Pushed events can be older than the progress they carry, backdate the
+        // steady clock stamp by however long ago the bridge sampled it
+        long long ageMs = 0;
+        if (handler.sampledAt > 0)
+        {
+            long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            ageMs = std::max(0LL, now - handler.sampledAt);
+        }
+        parsed.sampleTimeUs = steadyNowUs() - ageMs * 1000;
+    }
 
-    send(sock, request.c_str(), request.length(), 0);
+    if (parsed.trackId[0] != '\0')
+    {
+        // bpm_id says which track the bridge's BPM was measured for. When it's
+        // ours the value is worth keeping, otherwise the lookup is still pending
+        // and a cached value beats the previous song's tempo
+        // The first-beat offset comes with the BPM, so it is only trusted on the same terms
+        float cached;
+        bool bpmIsOurs = handler.hasBpmId && std::strcmp(handler.bpmId, parsed.trackId) == 0;
+        if (bpmIsOurs)
+            StoreBpm(parsed.trackId, parsed.bpm);
+        else if (CachedBpm(parsed.trackId, cached))
+            parsed.bpm = cached;
+        parsed.firstBeatMs = bpmIsOurs ? handler.firstBeatMs : -1.f;
+
+        if (std::strcmp(parsed.trackId, m_currentTrack.trackId) != 0)
+            RequestPrefetch();
+    }
 
-    // Receive response
-    std::string response;
-    char buffer[4096];
-    int bytesReceived;
+    m_currentTrack = parsed;
 
-    while ((bytesReceived = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0)
+    if (std::strcmp(m_currentTrack.trackName, m_sharedTrack.trackName) != 0)
     {
-        buffer[bytesReceived] = '\0';
-        response += buffer;
+        std::cout << "Current track: " << m_currentTrack.trackName
+            << " (BPM: " << m_currentTrack.bpm << ")\n";
     }
 
-    closesocket(sock);
+    PublishTrack();
+    return true;
+}
+
+// Only the polling thread writes, so the shared copy can be read here without the seqlock
+void SpotifyClient::PublishTrack()
+{
+    bool changed = m_currentTrack.bpm != m_sharedTrack.bpm
+        || m_currentTrack.isPlaying != m_sharedTrack.isPlaying
+        || std::strcmp(m_currentTrack.trackName, m_sharedTrack.trackName) != 0
+        || std::strcmp(m_currentTrack.artistName, m_sharedTrack.artistName) != 0;
+
+    unsigned int sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&m_sharedTrack, &m_currentTrack, sizeof(TrackInfo));
 
-    // Extract JSON body (after headers)
-    size_t bodyStart = response.find("\r\n\r\n");
-    if (bodyStart != std::string::npos)
+    m_sequence.store(sequence + 2, std::memory_order_release);
+    m_bpm.store(m_currentTrack.bpm, std::memory_order_relaxed);
+
+    if (changed)
+        m_generation.fetch_add(1, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// BPM cache
+
+// Bridge file first, our own entries win where both have a track
+void SpotifyClient::LoadBpmCache()
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+    for (const char* path : { BRIDGE_BPM_CACHE_PATH, BPM_CACHE_PATH })
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+            continue;
+
+        nlohmann::json data = nlohmann::json::parse(file, nullptr, false);
+        if (data.is_discarded() || !data.is_object())
+            continue;
+
+        for (auto it = data.begin(); it != data.end(); ++it)
+        {
+            if (it.value().is_number() && it.value().get<float>() > 0.f)
+                m_bpmCache[it.key()] = it.value().get<float>();
+        }
+    }
+
+    std::cout << "Spotify BPM cache: " << m_bpmCache.size() << " tracks" << std::endl;
+}
+
+// Only our own file is written, the bridge owns bpm_cache.json
+void SpotifyClient::SaveBpmCache()
+{
+    nlohmann::json data = nlohmann::json::object();
     {
-        return response.substr(bodyStart + 4);
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        if (!m_cacheDirty)
+            return;
+
+        for (const auto& entry : m_bpmCache)
+            data[entry.first] = entry.second;
+        m_cacheDirty = false;
     }
 
-    return "";
-#else
-   
-    return "";
-#endif
+    std::ofstream file(BPM_CACHE_PATH);
+    if (file.is_open())
+        file << data.dump(2);
+    else
+        std::cerr << "Failed to save BPM cache: " << BPM_CACHE_PATH << std::endl;
 }
 
-void SpotifyClient::ParseTrackData(const std::string& jsonResponse)
+bool SpotifyClient::CachedBpm(const char* trackId, float& bpm)
 {
-    std::lock_guard<std::mutex> lock(m_trackMutex);
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto cached = m_bpmCache.find(trackId);
+    if (cached == m_bpmCache.end())
+        return false;
+    bpm = cached->second;
+    return true;
+}
+
+void SpotifyClient::StoreBpm(const std::string& trackId, float bpm)
+{
+    if (trackId.empty() || bpm <= 0.f)
+        return;
 
-    if (jsonResponse.find("\"error\"") != std::string::npos)
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    float& entry = m_bpmCache[trackId];
+    if (entry != bpm)
     {
-        m_currentTrack.isPlaying = false;
+        entry = bpm;
+        m_cacheDirty = true;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Queue prefetch
+
+void SpotifyClient::RequestPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_prefetchRequested = true;
+    }
+    m_stopCondition.notify_all();
+}
+
+void SpotifyClient::PrefetchLoop()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            m_stopCondition.wait(lock, [this] { return !m_isRunning || m_prefetchRequested; });
+            if (!m_isRunning)
+                break;
+            m_prefetchRequested = false;
+        }
+
+        PrefetchUpcoming();
+        SaveBpmCache();
+    }
+}
+
+// Ask the bridge what plays next and make sure each of those has a cached BPM,
+// so the tempo is right from the first frame of the next song
+void SpotifyClient::PrefetchUpcoming()
+{
+    std::string body;
+    if (!m_prefetchConnection.get("/queue?n=" + std::to_string(PREFETCH_COUNT), body)
+        || m_prefetchConnection.getLastStatus() != 200)
+    {
+        return; // older bridge without /queue
+    }
+
+    nlohmann::json data = nlohmann::json::parse(body, nullptr, false);
+    if (data.is_discarded() || !data.contains("queue") || !data["queue"].is_array())
         return;
+
+    int upcoming = 0;
+    int fetched = 0;
+    for (const auto& item : data["queue"])
+    {
+        if (!m_isRunning)
+            return;
+        if (!item.is_object() || !item.contains("id") || !item["id"].is_string())
+            continue;
+
+        std::string id = item["id"].get<std::string>();
+        ++upcoming;
+
+        if (item.contains("bpm") && item["bpm"].is_number())
+        {
+            StoreBpm(id, item["bpm"].get<float>());
+            continue;
+        }
+
+        float bpm;
+        if (CachedBpm(id.c_str(), bpm))
+            continue;
+
+        if (!m_prefetchConnection.get("/bpm?id=" + id, body) || m_prefetchConnection.getLastStatus() != 200)
+            continue;
+
+        nlohmann::json answer = nlohmann::json::parse(body, nullptr, false);
+        if (!answer.is_discarded() && answer.contains("bpm") && answer["bpm"].is_number())
+        {
+            StoreBpm(id, answer["bpm"].get<float>());
+            ++fetched;
+        }
     }
 
-    m_currentTrack.isPlaying = (jsonResponse.find("\"playing\":true") != std::string::npos);
+    std::cout << "Spotify prefetch: " << upcoming << " upcoming tracks, " << fetched << " BPMs looked up" << std::endl;
+}
+
+// ---------------------------------------------------------------------------
+// Offline parse benchmark
 
-    // Extract track name
-    size_t namePos = jsonResponse.find("\"name\":");
-    if (namePos != std::string::npos)
+bool SpotifyClient::BenchmarkParse(const std::string& folder)
+{
+    const int TIMED_PARSES = 20000;
+    const int CORRUPTED_COPIES = 2000;
+
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(folder, ec))
     {
-        size_t start = jsonResponse.find("\"", namePos + 7) + 1;
-        size_t end = jsonResponse.find("\"", start);
-        m_currentTrack.trackName = jsonResponse.substr(start, end - start);
+        if (entry.path().extension() == ".json")
+            files.push_back(entry.path());
     }
+    std::sort(files.begin(), files.end());
 
-    size_t bpmPos = jsonResponse.find("\"bpm\":");
-    if (bpmPos != std::string::npos)
+    if (files.empty())
     {
-        size_t start = bpmPos + 6;
-        size_t end = jsonResponse.find_first_of(",}", start);
-        m_currentTrack.bpm = std::stof(jsonResponse.substr(start, end - start));
+        std::cerr << "No .json payloads in " << folder << std::endl;
+        return false;
     }
 
-    static std::string lastTrack;
-    if (m_currentTrack.trackName != lastTrack)
+    SpotifyClient client;
+    std::mt19937 random(1234);  // same corruptions every run
+    bool allParsed = true;
+
+    // ParseTrackData logs track changes and JSON errors, far too much for thousands of calls
+    std::ostringstream discard;
+    std::streambuf* out = nullptr;
+    std::streambuf* err = nullptr;
+    auto quiet = [&](bool on)
     {
-        std::cout << "Current track: " << m_currentTrack.trackName
-            << " (BPM: " << m_currentTrack.bpm << ")\n";
-        lastTrack = m_currentTrack.trackName;
+        if (on)
+        {
+            out = std::cout.rdbuf(discard.rdbuf());
+            err = std::cerr.rdbuf(discard.rdbuf());
+        }
+        else
+        {
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+        }
+        discard.str("");
+    };
+
+    for (const auto& path : files)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string payload((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        quiet(true);
+        client.m_currentTrack = TrackInfo{};
+        bool parsed = client.ParseTrackData(payload);
+
+        // SAX handler against the DOM parse it replaced
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TIMED_PARSES; ++i)
+            client.ParseTrackData(payload);
+        double saxNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / TIMED_PARSES;
+
+        int domObjects = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TIMED_PARSES; ++i)
+            domObjects += nlohmann::json::parse(payload, nullptr, false).is_object();
+        double domNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / TIMED_PARSES;
+
+        // Every prefix, as a dropped connection would leave it
+        int truncatedAccepted = 0;
+        for (size_t length = 0; length < payload.size(); ++length)
+        {
+            if (client.ParseTrackData(std::string_view(payload.data(), length)))
+                ++truncatedAccepted;
+        }
+
+        // Flipped, dropped and inserted bytes
+        int corruptedAccepted = 0;
+        for (int i = 0; i < CORRUPTED_COPIES && !payload.empty(); ++i)
+        {
+            std::string corrupted = payload;
+            int edits = 1 + static_cast<int>(random() % 4);
+            for (int e = 0; e < edits && !corrupted.empty(); ++e)
+            {
+                size_t at = random() % corrupted.size();
+                switch (random() % 3)
+                {
+                case 0: corrupted[at] = static_cast<char>(random() % 256); break;
+                case 1: corrupted.erase(at, 1); break;
+                default: corrupted.insert(at, 1, "{}[]\",:0e-\\x"[random() % 12]); break;
+                }
+            }
+            if (client.ParseTrackData(corrupted))
+                ++corruptedAccepted;
+        }
+        quiet(false);
+
+        std::cout << path.filename().string() << " (" << payload.size() << " bytes): "
+            << (parsed ? "ok" : "FAILED") << ", " << saxNs << "ns per parse (DOM " << domNs << "ns), "
+            << truncatedAccepted << "/" << payload.size() << " truncations and "
+            << corruptedAccepted << "/" << CORRUPTED_COPIES << " corrupted copies accepted" << std::endl;
+        allParsed = allParsed && parsed;
     }
-}
\ No newline at end of file
+
+    // Numbers no field can hold: every one has to be turned away
+    const char* outOfRange[] = {
+        "{\"progress_ms\":1e300}", "{\"duration_ms\":-1e300}", "{\"progress_ms\":2147483648}",
+        "{\"duration_ms\":18446744073709551615}", "{\"changed_at\":9.3e18}", "{\"sampled_at\":-1e19}",
+        "{\"bpm\":1e300}", "{\"first_beat_ms\":-1e39}", "{\"progress_ms\":1e400}" };
+    int rejected = 0;
+    quiet(true);
+    for (const char* payload : outOfRange)
+    {
+        if (!client.ParseTrackData(payload))
+            ++rejected;
+    }
+    quiet(false);
+
+    int total = static_cast<int>(std::size(outOfRange));
+    std::cout << "Out of range numbers: " << rejected << "/" << total << " rejected" << std::endl;
+    return allParsed && rejected == total;
+}
@@ -1,27 +1,40 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#endif
+#include <unordered_map>
+#include "HttpConnection.h"
 
 class SpotifyClient
 {
 public:
+    // Plain fixed-size snapshot so readers can copy it without locking or allocating
     struct TrackInfo
     {
-        std::string trackName;
-        std::string artistName;
-        std::string albumName;
+        static constexpr int TEXT_SIZE = 128;
+        static constexpr int ID_SIZE = 64;
+
+        char trackId[ID_SIZE] = {};
+        char trackName[TEXT_SIZE] = {};
+        char artistName[TEXT_SIZE] = {};
+        char albumName[TEXT_SIZE] = {};
         float bpm = 0.f;
+        float firstBeatMs = -1.f;   // bridge's first_beat_ms for this track, -1 if it sent none
         int durationMs = 0;
         int progressMs = 0;
         bool isPlaying = false;
+        long long sampleTimeUs = 0; // steady clock time progressMs was true at, 0 if never
+    };
+
+    struct Telemetry
+    {
+        unsigned int requests = 0;      // polls plus event stream subscriptions
+        unsigned int failures = 0;
+        unsigned int pushedEvents = 0;
+        double averageStalenessMs = 0.0; // time-averaged age of the data the game sees
     };
 
     SpotifyClient();
@@ -29,15 +42,92 @@ public:
 
     void StartPolling();
     void StopPolling();
-    TrackInfo GetCurrentTrack();
+    // Safe from any thread, never blocks the polling thread
+    TrackInfo GetCurrentTrack() const;
+    float GetBpm() const { return m_bpm.load(std::memory_order_relaxed); }
+    // Bumped whenever track, BPM or playing state changes
+    unsigned int GetGeneration() const { return m_generation.load(std::memory_order_acquire); }
+
+    // Last reported progress moved forward by the time since it was sampled
+    double GetPlaybackPositionMs() const;
+    // 0..1 position within the current beat, beatOffsetMs is where the first beat
+    // lands. A first_beat_ms from the bridge overrides it for the track it came with.
+    // Returns -1 until a playing track with a BPM and progress has been seen
+    float GetBeatPhase(float beatOffsetMs = 0.f) const;
+    HttpConnection::Stats GetConnectionStats() const;
+    // Time from the bridge seeing a change to this client parsing it, -1 until the first pushed event
+    float GetLastUpdateLatencyMs() const { return m_lastUpdateLatencyMs; }
+    Telemetry GetTelemetry() const;
+
+    // Local BPM cache, merged with the bridge's bpm_cache.json and warmed from the play queue
+    static constexpr const char* BPM_CACHE_PATH = "bpm_cache_client.json";
+    static constexpr const char* BRIDGE_BPM_CACHE_PATH = "../../Spotify test/bpm_cache.json";
+    static constexpr int PREFETCH_COUNT = 3;   // upcoming tracks to warm
+
+    // "--bench-parse <folder>": times ParseTrackData over every recorded bridge
+    // payload in the folder, then feeds it every truncation and a few thousand
+    // corrupted copies of each, and checks out of range numbers are rejected.
+    // False if a recorded payload doesn't parse or an out of range one does
+    static constexpr const char* PAYLOAD_FOLDER = "../../Spotify test/payloads";
+    static bool BenchmarkParse(const std::string& folder);
 
 private:
     std::thread m_pollingThread;
     std::atomic<bool> m_isRunning;
-    std::mutex m_trackMutex;
-    TrackInfo m_currentTrack;
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopCondition;   // lets StopPolling cut a poll wait short
+
+    // Seqlock: odd sequence means the polling thread is mid-write
+    std::atomic<unsigned int> m_sequence{ 0 };
+    TrackInfo m_sharedTrack;
+    TrackInfo m_currentTrack;   // polling thread's working copy
+    std::atomic<float> m_bpm{ 0.f };
+
+    // BPM by track id. Filled from parsed events and by the prefetch thread
+    std::mutex m_cacheMutex;
+    std::unordered_map<std::string, float> m_bpmCache;
+    bool m_cacheDirty = false;
+
+    // Prefetch thread, woken through m_stopCondition when the track changes
+    std::thread m_prefetchThread;
+    HttpConnection m_prefetchConnection;
+    bool m_prefetchRequested = false;   // guarded by m_stopMutex
+    std::atomic<unsigned int> m_generation{ 0 };
+
+    // Keep-alive connection to the local bridge, only used by the polling thread
+    HttpConnection m_connection;
+    HttpConnection m_eventConnection;   // /events push stream
+    std::string m_response; // reused between polls
+    std::string m_eventLine;
+    std::string m_eventData;
+    std::atomic<float> m_lastUpdateLatencyMs{ -1.f };
+    long long m_lastChangedAt = -1;     // changed_at of the last parsed event, -1 if absent
+
+    // Poll scheduling (polling thread only)
+    int m_consecutiveFailures = 0;
+
+    // Staleness accounting, integrated each time the data is confirmed fresh
+    mutable std::mutex m_telemetryMutex;
+    long long m_lastFreshUs = 0;
+    double m_observedUs = 0.0;
+    double m_staleAreaUs = 0.0;    // integral of data age over m_observedUs
+    unsigned int m_pushedEvents = 0;
 
     void PollingLoop();
-    std::string HttpGet(const std::string& host, const std::string& path);
-    void ParseTrackData(const std::string& jsonResponse);
+    void ReadEvents();
+    bool PollOnce(int& pollCount);
+    int NextPollDelayMs(bool lastPollOk);
+    bool WaitForNextPoll(int ms);
+    void MarkFresh(bool pushed);
+    bool HttpGet(const std::string& path, std::string& body);
+    bool ParseTrackData(std::string_view jsonResponse);
+    void PublishTrack();
+
+    void LoadBpmCache();
+    void SaveBpmCache();
+    bool CachedBpm(const char* trackId, float& bpm);
+    void StoreBpm(const std::string& trackId, float bpm);
+    void RequestPrefetch();
+    void PrefetchLoop();
+    void PrefetchUpcoming();
 };
\ No newline at end of file
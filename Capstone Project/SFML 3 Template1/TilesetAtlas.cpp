@@ -0,0 +1,55 @@
+#include "TilesetAtlas.h"
+#include <algorithm>
+#include <iostream>
+
+bool TilesetAtlas::load(int tileSize)
+{
+    const GameTheme themes[THEME_COUNT] = { GameTheme::Forest, GameTheme::Medieval, GameTheme::Factory, GameTheme::Hub };
+
+    std::array<sf::Image, THEME_COUNT> images;
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    for (int i = 0; i < THEME_COUNT; ++i)
+    {
+        std::string path = DynamicBackground::GetTilesetTexturePath(themes[i]);
+        if (!images[i].loadFromFile(path))
+        {
+            std::cout << "Failed to load tileset: " << path << std::endl;
+            return false;
+        }
+
+        width = std::max(width, images[i].getSize().x);
+        height += images[i].getSize().y;
+    }
+
+    // Stack them top to bottom. Tiles are sampled with nearest filtering and
+    // inset UVs, so neighbouring tilesets can't bleed into each other
+    sf::Image atlas;
+    atlas.resize({ width, height }, sf::Color::Transparent);
+
+    unsigned int y = 0;
+    for (int i = 0; i < THEME_COUNT; ++i)
+    {
+        if (!atlas.copy(images[i], { 0, y }))
+        {
+            std::cout << "Failed to pack tileset " << i << " into the atlas" << std::endl;
+            return false;
+        }
+
+        TilesetRegion& region = m_regions[static_cast<int>(themes[i])];
+        region.columns = static_cast<int>(images[i].getSize().x) / tileSize;
+        region.uvOffset = { 0.f, static_cast<float>(y) };
+        y += images[i].getSize().y;
+    }
+
+    if (!m_texture.loadFromImage(atlas))
+    {
+        std::cout << "Failed to upload tileset atlas" << std::endl;
+        return false;
+    }
+    m_texture.setSmooth(false);
+
+    std::cout << "Tileset atlas: " << width << "x" << height << " (" << THEME_COUNT << " themes)" << std::endl;
+    return true;
+}
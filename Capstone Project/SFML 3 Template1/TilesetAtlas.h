@@ -0,0 +1,23 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include "ChunkTemplate.h"
+#include "Headers/DynamicBackground.h"
+
+// Every theme's tileset stacked into one texture, decoded and uploaded once at
+// startup. Chunk vertices carry their theme's offset into it, so a theme switch
+// only changes which templates are placed - no PNG decode, no GPU upload
+class TilesetAtlas
+{
+public:
+    static constexpr int THEME_COUNT = 4;
+
+    bool load(int tileSize);
+
+    const sf::Texture& getTexture() const { return m_texture; }
+    const TilesetRegion& getRegion(GameTheme theme) const { return m_regions[static_cast<int>(theme)]; }
+
+private:
+    sf::Texture m_texture;
+    std::array<TilesetRegion, THEME_COUNT> m_regions{};
+};
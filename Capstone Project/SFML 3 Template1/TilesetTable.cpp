@@ -0,0 +1,168 @@
+#include "TilesetTable.h"
+#include "json.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    std::mutex s_tableMutex;
+    std::unordered_map<std::string, std::shared_ptr<const TilesetTable>> s_tables;
+
+    // Tables are loaded on the streamer and watcher threads, so a field with
+    // the wrong type reads as the fallback instead of throwing
+    int intField(const nlohmann::json& object, const char* key, int fallback)
+    {
+        if (!object.is_object())
+            return fallback;
+        auto it = object.find(key);
+        return it != object.end() && it->is_number_integer() ? it->get<int>() : fallback;
+    }
+
+    uint8_t flagForProperty(const std::string& name)
+    {
+        if (name == "solid") return TILE_SOLID;
+        if (name == "one_way" || name == "oneway") return TILE_ONE_WAY;
+        if (name == "hazard") return TILE_HAZARD;
+        if (name == "animated") return TILE_ANIMATED;
+        if (name == "light") return TILE_LIGHT;
+        return 0;
+    }
+
+    // Tiled stores a frame list per tile. The shader steps the UV along the row,
+    // so only evenly spaced frames that start at the tile and stay in its row play
+    bool parseAnimation(int localId, int columns, const nlohmann::json& frames, TileAnimation& out)
+    {
+        if (!frames.is_array() || frames.size() < 2 || frames.size() > 255 || columns <= 0)
+            return false;
+        if (intField(frames[0], "tileid", -1) != localId)
+            return false;
+
+        int stride = intField(frames[1], "tileid", -1) - localId;
+        int duration = intField(frames[0], "duration", 100);
+        for (std::size_t i = 1; i < frames.size(); ++i)
+        {
+            if (intField(frames[i], "tileid", -1) != localId + static_cast<int>(i) * stride)
+                return false;
+            if (intField(frames[i], "duration", 100) != duration)
+                return false;
+        }
+
+        int lastColumn = localId % columns + (static_cast<int>(frames.size()) - 1) * stride;
+        if (stride <= 0 || stride > 255 || lastColumn >= columns)
+            return false;
+
+        out.frames = static_cast<uint8_t>(frames.size());
+        out.stride = static_cast<uint8_t>(stride);
+        out.frameCs = static_cast<uint8_t>(std::clamp((duration + 5) / 10, 1, 255));
+        return true;
+    }
+}
+
+std::shared_ptr<const TilesetTable> TilesetTable::get(const std::string& tsjPath)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_tableMutex);
+        auto it = s_tables.find(tsjPath);
+        if (it != s_tables.end())
+            return it->second;
+    }
+
+    // Parse outside the lock, a failed load still caches the fallback table
+    auto table = std::make_shared<TilesetTable>();
+    table->load(tsjPath);
+
+    std::lock_guard<std::mutex> lock(s_tableMutex);
+    return s_tables.emplace(tsjPath, std::move(table)).first->second;
+}
+
+std::shared_ptr<const TilesetTable> TilesetTable::reload(const std::string& tsjPath)
+{
+    // A half-saved file would otherwise swap in the fallback ids
+    auto table = std::make_shared<TilesetTable>();
+    if (!table->load(tsjPath))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(s_tableMutex);
+    s_tables[tsjPath] = table;
+    return table;
+}
+
+bool TilesetTable::load(const std::string& tsjPath)
+{
+    m_path = tsjPath;
+    m_flags.assign(2, 0);
+    m_animations.clear();
+
+    bool parsed = false;
+    std::ifstream f(tsjPath);
+    if (!f.is_open())
+    {
+        std::cerr << "Failed to open tileset: " << tsjPath << std::endl;
+    }
+    else
+    {
+        nlohmann::json tilesetData = nlohmann::json::parse(f, nullptr, false);
+        if (tilesetData.is_discarded() || !tilesetData.is_object())
+        {
+            std::cerr << "Failed to parse tileset: " << tsjPath << std::endl;
+        }
+        else
+        {
+            parsed = true;
+            int tileCount = std::clamp(intField(tilesetData, "tilecount", 0), 0, static_cast<int>(UINT16_MAX));
+            int columns = intField(tilesetData, "columns", 0);
+            m_flags.assign(static_cast<std::size_t>(tileCount) + 2, 0);
+
+            if (tilesetData.contains("tiles") && tilesetData["tiles"].is_array())
+            {
+                for (auto& tile : tilesetData["tiles"])
+                {
+                    int tileId = intField(tile, "id", -1) + 1;
+                    if (tileId <= 0 || tileId > tileCount)
+                        continue;
+
+                    uint8_t flags = 0;
+                    if (tile.contains("animation"))
+                    {
+                        flags |= TILE_ANIMATED;
+                        TileAnimation animation;
+                        if (parseAnimation(tileId - 1, columns, tile["animation"], animation))
+                            m_animations[static_cast<uint16_t>(tileId)] = animation;
+                        else
+                            std::cout << "Tile " << tileId << " in " << tsjPath
+                                << " has frames the tile shader can't step through, drawn static" << std::endl;
+                    }
+                    if (tile.contains("properties") && tile["properties"].is_array())
+                    {
+                        for (auto& prop : tile["properties"])
+                        {
+                            if (!prop.is_object() || !prop.contains("name") || !prop["name"].is_string())
+                                continue;
+                            if (prop.contains("value") && prop["value"].is_boolean() && prop["value"].get<bool>())
+                                flags |= flagForProperty(prop["name"].get<std::string>());
+                        }
+                    }
+                    m_flags[tileId] = flags;
+                }
+            }
+        }
+    }
+
+    // Fallback to hardcoded if tileset loading failed
+    bool anySolid = false;
+    for (uint8_t flags : m_flags)
+        anySolid |= (flags & TILE_SOLID) != 0;
+    if (!anySolid)
+    {
+        std::cout << "Warning: No solid tiles loaded from tileset, using defaults" << std::endl;
+        if (m_flags.size() < 31)
+            m_flags.resize(31, 0);
+        m_flags[3] |= TILE_SOLID;
+        m_flags[29] |= TILE_SOLID;
+    }
+
+    return parsed;
+}
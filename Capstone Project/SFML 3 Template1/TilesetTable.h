@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Tile behaviour read from the custom properties in a tileset's .tsj
+enum TileFlags : uint8_t
+{
+    TILE_SOLID = 1 << 0,        // "solid"
+    TILE_ONE_WAY = 1 << 1,      // "one_way": only blocks from above
+    TILE_HAZARD = 1 << 2,       // "hazard": hurts on contact
+    TILE_ANIMATED = 1 << 3,     // has a Tiled animation, or "animated"
+    TILE_LIGHT = 1 << 4,        // "light": emits light
+};
+
+// A Tiled tile animation the GPU can play: frames evenly spaced along one
+// row of the tileset, each shown for the same time
+struct TileAnimation
+{
+    uint8_t frames = 0;         // including the tile itself, which is the first
+    uint8_t stride = 0;         // tiles from one frame to the next
+    uint8_t frameCs = 0;        // frame length in hundredths of a second
+};
+
+// Flags for every tile id of one tileset in a flat array, parsed once per
+// file. A lookup is one clamped index, no hashing and no branch, so a chunk's
+// collision is built straight from its ids
+class TilesetTable
+{
+public:
+    // Cached per path and shared; safe to call from the streamer thread
+    static std::shared_ptr<const TilesetTable> get(const std::string& tsjPath);
+    // Parses the file again and replaces the cached table. Null, and the old
+    // table kept, if the file doesn't parse. Templates already built keep the
+    // table they were built with until they are reloaded too
+    static std::shared_ptr<const TilesetTable> reload(const std::string& tsjPath);
+
+    bool load(const std::string& tsjPath);
+
+    // Tiled ids are 1-based, 0 and ids past the tileset read as no flags
+    uint8_t flags(uint16_t id) const
+    {
+        std::size_t last = m_flags.size() - 1;
+        return m_flags[id < last ? id : last];
+    }
+    bool has(uint16_t id, TileFlags flag) const { return (flags(id) & flag) != 0; }
+    // Null unless the tile has an animation the shader can play
+    const TileAnimation* animation(uint16_t id) const
+    {
+        auto it = m_animations.find(id);
+        return it != m_animations.end() ? &it->second : nullptr;
+    }
+
+    const std::string& path() const { return m_path; }
+    int tileCount() const { return static_cast<int>(m_flags.size()) - 2; }
+
+private:
+    std::string m_path;
+    std::vector<uint8_t> m_flags = std::vector<uint8_t>(2, 0);   // [0] empty, ids, trailing 0 for out of range
+    std::unordered_map<uint16_t, TileAnimation> m_animations;    // few tiles animate, only read when building geometry
+};
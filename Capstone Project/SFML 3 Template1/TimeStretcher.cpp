@@ -0,0 +1,232 @@
+#include "TimeStretcher.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRETCH_SSE
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace
+{
+    // Cross-correlation inner loop, four lanes at a time where SSE is available
+    float dot(const float* a, const float* b, int n)
+    {
+        int i = 0;
+        float sum = 0.f;
+#ifdef STRETCH_SSE
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+}
+
+void TimeStretcher::prepare(unsigned int channelCount)
+{
+    m_channelCount = channelCount;
+
+    m_window.resize(WINDOW);
+    for (int i = 0; i < WINDOW; ++i)
+    {
+        // periodic Hann sums to exactly 1 at 50% overlap
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / WINDOW));
+    }
+
+    m_overlapAdd.assign(static_cast<std::size_t>(WINDOW) * channelCount, 0.f);
+    m_hopOut.assign(static_cast<std::size_t>(HOP) * channelCount, 0);
+    m_target.assign(HOP, 0.f);
+    m_search.assign(HOP + 2 * SEEK, 0.f);
+
+    reset(0.0);
+}
+
+void TimeStretcher::reset(double sourceFrame)
+{
+    std::fill(m_overlapAdd.begin(), m_overlapAdd.end(), 0.f);
+    m_hopRead = HOP;
+    m_hopLength = HOP;
+    m_inTail = false;
+    m_sourcePos = sourceFrame;
+    m_prevStart = -1;
+}
+
+double TimeStretcher::getPlaybackFrame() const
+{
+    if (m_prevStart < 0)
+        return m_sourcePos;
+    return static_cast<double>(m_prevStart + m_hopRead);
+}
+
+std::size_t TimeStretcher::process(const std::int16_t* source, std::size_t sourceFrames, double ratio,
+    std::int16_t* out, std::size_t outFrames)
+{
+    std::size_t written = 0;
+
+    while (written < outFrames)
+    {
+        if (m_hopRead >= m_hopLength && !synthesiseHop(source, sourceFrames, ratio))
+            break; // ran out of source
+
+        std::size_t frames = std::min<std::size_t>(m_hopLength - m_hopRead, outFrames - written);
+        std::memcpy(out + written * m_channelCount,
+            m_hopOut.data() + static_cast<std::size_t>(m_hopRead) * m_channelCount,
+            frames * m_channelCount * sizeof(std::int16_t));
+
+        m_hopRead += static_cast<int>(frames);
+        written += frames;
+    }
+
+    return written;
+}
+
+void TimeStretcher::toMono(const std::int16_t* source, long firstFrame, int frameCount, float* out) const
+{
+    const std::int16_t* in = source + static_cast<std::size_t>(firstFrame) * m_channelCount;
+    if (m_channelCount == 1)
+    {
+        for (int i = 0; i < frameCount; ++i)
+            out[i] = in[i];
+    }
+    else
+    {
+        for (int i = 0; i < frameCount; ++i)
+            out[i] = (in[i * 2] + in[i * 2 + 1]) * 0.5f;
+    }
+}
+
+// Search around the analysis position for the segment whose start best matches
+// the natural continuation of the previous segment
+long TimeStretcher::findBestOffset(const std::int16_t* source, std::size_t sourceFrames, long start)
+{
+    long natural = m_prevStart + HOP;
+    if (natural + HOP > static_cast<long>(sourceFrames))
+        return start;
+
+    long lo = std::max(-static_cast<long>(SEEK), -start);
+    long hi = std::min(static_cast<long>(SEEK), static_cast<long>(sourceFrames) - WINDOW - start);
+    if (hi < lo)
+        return start;
+
+    toMono(source, natural, HOP, m_target.data());
+    toMono(source, start + lo, static_cast<int>(hi - lo) + HOP, m_search.data());
+
+    // coarse pass every other offset, then refine the neighbours of the winner
+    long best = lo;
+    float bestScore = -1e30f;
+    for (long d = lo; d <= hi; d += 2)
+    {
+        float score = dot(m_target.data(), m_search.data() + (d - lo), HOP);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = d;
+        }
+    }
+    for (long d = std::max(lo, best - 1); d <= std::min(hi, best + 1); d += 2)
+    {
+        float score = dot(m_target.data(), m_search.data() + (d - lo), HOP);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = d;
+        }
+    }
+
+    return start + best;
+}
+
+bool TimeStretcher::synthesiseHop(const std::int16_t* source, std::size_t sourceFrames, double ratio)
+{
+    long start = std::max(0L, std::lround(m_sourcePos));
+    if (m_inTail || start + WINDOW > static_cast<long>(sourceFrames))
+        return flushTail(source, sourceFrames);
+
+    if (m_prevStart >= 0)
+        start = findBestOffset(source, sourceFrames, start);
+
+    // overlap-add the windowed segment
+    const std::int16_t* in = source + static_cast<std::size_t>(start) * m_channelCount;
+    float* ola = m_overlapAdd.data();
+    for (int i = 0; i < WINDOW; ++i)
+    {
+        float w = m_window[i];
+        for (unsigned int c = 0; c < m_channelCount; ++c)
+        {
+            ola[i * m_channelCount + c] += w * in[i * m_channelCount + c];
+        }
+    }
+
+    // first half is now complete
+    std::size_t hopSamples = static_cast<std::size_t>(HOP) * m_channelCount;
+    for (std::size_t i = 0; i < hopSamples; ++i)
+    {
+        float s = std::clamp(ola[i], -32768.f, 32767.f);
+        m_hopOut[i] = static_cast<std::int16_t>(s);
+    }
+
+    std::memmove(ola, ola + hopSamples, hopSamples * sizeof(float));
+    std::fill(ola + hopSamples, ola + 2 * hopSamples, 0.f);
+
+    m_prevStart = start;
+    m_sourcePos += HOP * ratio;
+    m_hopRead = 0;
+    m_hopLength = HOP;
+    return true;
+}
+
+// Too little source left for another full segment. Play the rest out unstretched
+// instead of dropping it: the first tail hop adds the rising half of the window
+// to the last segment's pending fade-out (the two halves sum to 1), the hops after
+// that are straight copies up to the end of the source
+bool TimeStretcher::flushTail(const std::int16_t* source, std::size_t sourceFrames)
+{
+    long first;
+    bool blend = false;
+    if (!m_inTail)
+    {
+        m_inTail = true;
+        blend = m_prevStart >= 0;
+        first = blend ? m_prevStart + HOP : std::max(0L, std::lround(m_sourcePos));
+    }
+    else
+    {
+        first = m_prevStart + m_hopLength;
+    }
+
+    int frames = static_cast<int>(std::clamp(static_cast<long>(sourceFrames) - first, 0L, static_cast<long>(HOP)));
+    if (frames == 0)
+        return false;
+
+    const std::int16_t* in = source + static_cast<std::size_t>(first) * m_channelCount;
+    const float* ola = m_overlapAdd.data();
+    for (int i = 0; i < frames; ++i)
+    {
+        float w = blend ? m_window[i] : 1.f;
+        for (unsigned int c = 0; c < m_channelCount; ++c)
+        {
+            std::size_t at = static_cast<std::size_t>(i) * m_channelCount + c;
+            float s = std::clamp((blend ? ola[at] : 0.f) + w * in[at], -32768.f, 32767.f);
+            m_hopOut[at] = static_cast<std::int16_t>(s);
+        }
+    }
+
+    std::fill(m_overlapAdd.begin(), m_overlapAdd.end(), 0.f);
+    m_prevStart = first;
+    m_hopRead = 0;
+    m_hopLength = frames;
+    return true;
+}
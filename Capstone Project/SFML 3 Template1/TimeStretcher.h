@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// WSOLA time-stretcher for the music stream. Changes tempo without changing
+// pitch by overlap-adding windowed source segments at a different hop, picking
+// each segment so it lines up with the waveform of the previous one.
+// All buffers are sized in prepare(), process() never allocates
+class TimeStretcher
+{
+public:
+    static constexpr int WINDOW = 1024;     // frames per segment (~23ms at 44.1kHz)
+    static constexpr int HOP = WINDOW / 2;  // synthesis hop, 50% overlap
+    static constexpr int SEEK = 256;        // +/- frames searched for the best join
+
+    void prepare(unsigned int channelCount);
+    void reset(double sourceFrame);
+
+    // Fills up to outFrames of stretched audio, returns frames written (0 at end of source)
+    std::size_t process(const std::int16_t* source, std::size_t sourceFrames, double ratio,
+        std::int16_t* out, std::size_t outFrames);
+
+    // Source frame matching the next frame process() will output
+    double getPlaybackFrame() const;
+
+private:
+    bool synthesiseHop(const std::int16_t* source, std::size_t sourceFrames, double ratio);
+    bool flushTail(const std::int16_t* source, std::size_t sourceFrames);
+    long findBestOffset(const std::int16_t* source, std::size_t sourceFrames, long start);
+    void toMono(const std::int16_t* source, long firstFrame, int frameCount, float* out) const;
+
+    unsigned int m_channelCount = 0;
+
+    std::vector<float> m_window;        // Hann window
+    std::vector<float> m_overlapAdd;    // WINDOW frames, interleaved
+    std::vector<std::int16_t> m_hopOut; // finished HOP frames, interleaved
+    std::vector<float> m_target;        // mono natural continuation of the last segment
+    std::vector<float> m_search;        // mono source around the next analysis position
+
+    int m_hopRead = HOP;
+    int m_hopLength = HOP;      // frames in m_hopOut, only short for the last hop of the source
+    bool m_inTail = false;      // past the last full segment, playing out the rest of the source
+    double m_sourcePos = 0.0;   // analysis position of the next segment
+    long m_prevStart = -1;      // start frame of the last segment used
+};
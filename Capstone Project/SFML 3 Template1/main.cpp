@@ -22,14 +22,29 @@
 #endif 
 
 #include <iostream>
+#include <cstring>
 #include "Headers/Game.h"
+#include "ChunkBake.h"
+#include "SpotifyClient.h"
 
 /// <summary>
 /// main enrtry point
+/// "--bake" converts the Tiled chunks to .chunk files and exits (run after each build)
+/// "--bench-parse [folder]" times and fuzzes the Spotify bridge parser on recorded payloads
 /// </summary>
 /// <returns>success or failure</returns>
-int main()
+int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::strcmp(argv[1], "--bake") == 0)
+	{
+		return ChunkBake::bakeAll() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (argc > 1 && std::strcmp(argv[1], "--bench-parse") == 0)
+	{
+		const char* folder = argc > 2 ? argv[2] : SpotifyClient::PAYLOAD_FOLDER;
+		return SpotifyClient::BenchmarkParse(folder) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	Game game;
 	game.run();
 
@@ -12,6 +12,7 @@ const RAPIDAPI_KEY = 'f2d68e0833msh84f1270c3c1c05ap1a9a24jsnc36f89e6cb90';
 let tokens = {};
 let lastTrackId = null;
 let currentBPM = 120;
+let currentBPMTrackId = null;  // which track currentBPM was measured for
 
 // Load cached BPMs from file (if exists)
 let bpmCache = {};
@@ -114,6 +115,7 @@ function getCurrentlyPlaying(callback) {
           // Check cache first!
           if (bpmCache[trackId]) {
             currentBPM = bpmCache[trackId];
+            currentBPMTrackId = trackId;
             console.log(`📦 Using cached BPM: ${currentBPM} (saved 1 API call!)`);
           } else {
             fetchBPMFromRapidAPI(trackId);
@@ -121,10 +123,15 @@ function getCurrentlyPlaying(callback) {
         }
 
         callback({
+          id: trackId,
           track: trackName,
           artist: artistName,
           bpm: currentBPM,
-          playing: parsed?.is_playing
+          bpm_id: currentBPMTrackId,  // differs from id while the lookup is pending
+          playing: parsed?.is_playing,
+          progress_ms: parsed?.progress_ms,
+          duration_ms: parsed?.item?.duration_ms,
+          sampled_at: Date.now()  // lets the game extrapolate progress from an older event
         });
       } catch (err) {
         callback({ error: err.message, bpm: currentBPM });
@@ -136,8 +143,9 @@ function getCurrentlyPlaying(callback) {
   req.end();
 }
 
-// Fetch BPM from RapidAPI using Spotify track ID
-function fetchBPMFromRapidAPI(spotifyTrackId) {
+// Fetch BPM from RapidAPI using Spotify track ID.
+// Prefetches for upcoming tracks pass applyToCurrent = false and get the result in done()
+function fetchBPMFromRapidAPI(spotifyTrackId, applyToCurrent = true, done = () => {}) {
   console.log(`🎼 Fetching BPM from RapidAPI for track: ${spotifyTrackId}`);
 
   const options = {
@@ -161,27 +169,142 @@ function fetchBPMFromRapidAPI(spotifyTrackId) {
         
         if (res.statusCode === 429) {
           console.log('⚠ Rate limit hit - keeping last BPM:', currentBPM);
+          done(null);
           return;
         }
         
         if (parsed.tempo) {
-          currentBPM = parsed.tempo;
-          bpmCache[spotifyTrackId] = currentBPM;  // Cache it!
+          bpmCache[spotifyTrackId] = parsed.tempo;  // Cache it!
           saveBPMCache();  // Save to file for next time
-          console.log(`✅ BPM updated: ${currentBPM} (cached for future use)`);
+          done(parsed.tempo);
+
+          // Only apply if it's still the track that is playing
+          if (applyToCurrent && spotifyTrackId === lastTrackId) {
+            currentBPM = parsed.tempo;
+            currentBPMTrackId = spotifyTrackId;
+            console.log(`✅ BPM updated: ${currentBPM} (cached for future use)`);
+            if (lastState) publishState({ ...lastState, bpm: currentBPM, bpm_id: currentBPMTrackId });  // push right away, don't wait for the next poll
+          } else {
+            console.log(`✅ BPM cached for ${spotifyTrackId}: ${parsed.tempo}`);
+          }
         } else {
           console.log('⚠ No tempo in response:', parsed);
+          done(null);
         }
       } catch (err) {
         console.error('❌ Error parsing RapidAPI response:', err);
+        done(null);
+      }
+    });
+  });
+
+  req.on('error', (e) => {
+    console.error('❌ RapidAPI request error:', e);
+    done(null);
+  });
+  req.end();
+}
+
+// Upcoming tracks from the player queue, so the game can warm BPMs before they play
+function getQueue(limit, callback) {
+  if (!tokens.access_token) {
+    callback({ error: 'No access token yet.', queue: [] });
+    return;
+  }
+
+  const options = {
+    hostname: 'api.spotify.com',
+    path: '/v1/me/player/queue',
+    method: 'GET',
+    headers: { 'Authorization': `Bearer ${tokens.access_token}` },
+  };
+
+  const req = https.request(options, (res) => {
+    let data = '';
+    res.on('data', (chunk) => data += chunk);
+    res.on('end', () => {
+      try {
+        const parsed = data ? JSON.parse(data) : {};
+        const queue = (parsed.queue || []).slice(0, limit).map((item) => ({
+          id: item?.id,
+          track: item?.name,
+          artist: item?.artists?.[0]?.name,
+          bpm: bpmCache[item?.id]
+        }));
+        callback({ queue });
+      } catch (err) {
+        callback({ error: err.message, queue: [] });
       }
     });
   });
 
-  req.on('error', (e) => console.error('❌ RapidAPI request error:', e));
+  req.on('error', (e) => callback({ error: e.message, queue: [] }));
   req.end();
 }
 
+// Event stream (/events) - one Spotify poll shared by every subscriber,
+// pushed as Server-Sent Events only when something actually changes
+const EVENT_POLL_MS = 1000;
+const EVENT_PING_MS = 5000;
+let subscribers = [];
+let lastState = null;
+let lastStateKey = '';
+let eventPollTimer = null;
+
+// Progress is extrapolated by the game, so only a seek/scrub is worth pushing
+function hasSeeked(state) {
+  if (!lastState || !state.playing || state.progress_ms === undefined || lastState.progress_ms === undefined) return false;
+  const expected = lastState.progress_ms + (lastState.playing ? state.sampled_at - lastState.sampled_at : 0);
+  return Math.abs(state.progress_ms - expected) > 1500;
+}
+
+function publishState(state) {
+  const key = `${state.track}|${state.artist}|${state.bpm}|${state.bpm_id}|${state.playing}|${state.error}`;
+  if (key === lastStateKey && !hasSeeked(state)) return;
+
+  lastStateKey = key;
+  lastState = { ...state, changed_at: Date.now() };  // game measures delivery latency from this
+  const message = `data: ${JSON.stringify(lastState)}\n\n`;
+  subscribers.forEach((res) => res.write(message));
+}
+
+function pollForSubscribers() {
+  if (subscribers.length === 0) {
+    clearInterval(eventPollTimer);
+    eventPollTimer = null;
+    return;
+  }
+  getCurrentlyPlaying(publishState);
+}
+
+function subscribe(req, res) {
+  res.writeHead(200, {
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    'Connection': 'keep-alive',
+  });
+
+  // New subscriber gets the current state straight away
+  if (lastState) res.write(`data: ${JSON.stringify(lastState)}\n\n`);
+
+  subscribers.push(res);
+  console.log(`📡 Event subscriber connected (${subscribers.length})`);
+
+  // Keeps the socket alive and lets the game notice a dead bridge
+  const ping = setInterval(() => res.write(': ping\n\n'), EVENT_PING_MS);
+
+  req.on('close', () => {
+    clearInterval(ping);
+    subscribers = subscribers.filter((s) => s !== res);
+    console.log(`📡 Event subscriber left (${subscribers.length})`);
+  });
+
+  if (!eventPollTimer) {
+    eventPollTimer = setInterval(pollForSubscribers, EVENT_POLL_MS);
+    pollForSubscribers();
+  }
+}
+
 const { exec } = require('child_process');
 
 function openLogin() {
@@ -218,6 +341,26 @@ const server = http.createServer((req, res) => {
       res.end(JSON.stringify(data, null, 2));
     });
 
+  } else if (parsedUrl.pathname === '/events') {
+    subscribe(req, res);
+
+  } else if (parsedUrl.pathname === '/queue') {
+    const limit = Math.min(parseInt(parsedUrl.query.n, 10) || 3, 20);
+    getQueue(limit, (data) => {
+      res.writeHead(200, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify(data));
+    });
+
+  } else if (parsedUrl.pathname === '/bpm') {
+    const id = parsedUrl.query.id;
+    const reply = (bpm) => {
+      res.writeHead(200, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify(bpm ? { id, bpm } : { id, error: 'BPM unavailable' }));
+    };
+    if (!id) reply(null);
+    else if (bpmCache[id]) reply(bpmCache[id]);
+    else fetchBPMFromRapidAPI(id, false, reply);
+
   } else {
     res.writeHead(404, { 'Content-Type': 'text/plain' });
     res.end('Not Found');